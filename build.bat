@@ -39,7 +39,7 @@ if "%1"=="clean" (
 
 :: Compiler Settings
 set CXX=clang++
-set CXXFLAGS=-std=c++17 -Iinclude -Ideps/imgui -Ideps/imgui/backends -IC:/msys64/mingw64/include -DGLEW_STATIC
+set CXXFLAGS=-std=c++17 -O2 -Iinclude -Ideps/imgui -Ideps/imgui/backends -IC:/msys64/mingw64/include -DGLEW_STATIC
 set LIBS=-Lbin -LC:/msys64/mingw64/lib -lglew32 -lglfw3 -lopengl32 -lgdi32 -luser32 -lshell32 -lcomdlg32 -lole32
 
 :: Build target
@@ -67,11 +67,16 @@ call :cc "src\lore\LoreScribe.cpp"             "build\lore\LoreScribe.o"
 call :cc "src\lore\NameGenerator.cpp"          "build\lore\NameGenerator.o"
 call :cc "src\core\TerrainController.cpp"      "build\core\TerrainController.o"
 call :cc "src\core\NeighborFinder.cpp"         "build\core\NeighborFinder.o"
+call :cc "src\core\ThreadPool.cpp"            "build\core\ThreadPool.o"
+call :cc "src\core\LayerPyramid.cpp"          "build\core\LayerPyramid.o"
+call :cc "src\core\DiffusionSolver.cpp"       "build\core\DiffusionSolver.o"
 call :cc "src\visuals\MapRenderer.cpp"         "build\visuals\MapRenderer.o"
 call :cc "src\frontend\GuiController.cpp"      "build\frontend\GuiController.o"
 call :cc "src\frontend\EditorUI.cpp"           "build\frontend\EditorUI.o"
 call :cc "src\frontend\WikiEditor.cpp"           "build\frontend\WikiEditor.o"
 call :cc "src\biology\AgentSystem.cpp"         "build\biology\AgentSystem.o"
+call :cc "src\biology\InfluenceMap.cpp"        "build\biology\InfluenceMap.o"
+call :cc "src\biology\HerdSystem.cpp"          "build\biology\HerdSystem.o"
 call :cc "src\environment\ClimateSim.cpp"      "build\environment\ClimateSim.o"
 call :cc "src\environment\HydrologySim.cpp"    "build\environment\HydrologySim.o"
 call :cc "src\environment\ChaosField.cpp"      "build\environment\ChaosField.o"
@@ -80,6 +85,7 @@ call :cc "src\simulation\CivilizationSim.cpp"  "build\simulation\CivilizationSim
 call :cc "src\simulation\ConflictSystem.cpp"   "build\simulation\ConflictSystem.o"
 call :cc "src\simulation\LogisticsSystem.cpp"  "build\simulation\LogisticsSystem.o"
 call :cc "src\simulation\UnitSystem.cpp"       "build\simulation\UnitSystem.o"
+call :cc "src\simulation\FactionStats.cpp"     "build\simulation\FactionStats.o"
 call :cc "deps\imgui\imgui.cpp"                        "build\imgui\imgui.o"
 call :cc "deps\imgui\imgui_draw.cpp"                   "build\imgui\imgui_draw.o"
 call :cc "deps\imgui\imgui_tables.cpp"                 "build\imgui\imgui_tables.o"
@@ -104,7 +110,7 @@ if !BUILD_ERRORS! neq 0 (
 :: ============================================================
 :: STEP 2: Link Executables
 :: ============================================================
-set OBJ_COMMON=build\platform\WindowsUtils.o build\io\PlatformUtils.o build\io\BinaryExporter.o build\io\AssetManager.o build\io\LoreManager.o build\io\stb_image_impl.o build\lore\LoreScribe.o build\lore\NameGenerator.o build\imgui\imgui.o build\imgui\imgui_draw.o build\imgui\imgui_tables.o build\imgui\imgui_widgets.o build\imgui\imgui_stdlib.o build\imgui\imgui_impl_glfw.o build\imgui\imgui_impl_opengl3.o build\frontend\WikiEditor.o
+set OBJ_COMMON=build\platform\WindowsUtils.o build\core\ThreadPool.o build\core\LayerPyramid.o build\io\PlatformUtils.o build\io\BinaryExporter.o build\io\AssetManager.o build\io\LoreManager.o build\io\stb_image_impl.o build\lore\LoreScribe.o build\lore\NameGenerator.o build\imgui\imgui.o build\imgui\imgui_draw.o build\imgui\imgui_tables.o build\imgui\imgui_widgets.o build\imgui\imgui_stdlib.o build\imgui\imgui_impl_glfw.o build\imgui\imgui_impl_opengl3.o build\frontend\WikiEditor.o
 
 if "%TGT%"=="all" call :link_launcher
 if "%TGT%"=="launch" call :link_launcher
@@ -137,7 +143,7 @@ goto :eof
 
 :link_arch
 echo [LINK] Architect...
-%CXX% build\apps\App_Architect.o build\core\TerrainController.o build\core\NeighborFinder.o build\visuals\MapRenderer.o build\frontend\GuiController.o build\environment\ClimateSim.o build\environment\HydrologySim.o build\io\HeightmapLoader.o build\biology\AgentSystem.o build\environment\DisasterSystem.o %OBJ_COMMON% -o bin\TALEWEAVERS_Architect.exe %LIBS%
+%CXX% build\apps\App_Architect.o build\core\TerrainController.o build\core\NeighborFinder.o build\visuals\MapRenderer.o build\frontend\GuiController.o build\environment\ClimateSim.o build\environment\HydrologySim.o build\io\HeightmapLoader.o build\biology\AgentSystem.o build\biology\InfluenceMap.o build\environment\DisasterSystem.o build\simulation\FactionStats.o %OBJ_COMMON% -o bin\TALEWEAVERS_Architect.exe %LIBS%
 if !errorlevel! neq 0 ( echo [ERROR] Architect link failed. & exit /b 1 )
 goto :eof
 
@@ -149,7 +155,7 @@ goto :eof
 
 :link_engine
 echo [LINK] Engine...
-%CXX% build\apps\App_Sim.o build\core\NeighborFinder.o build\biology\AgentSystem.o build\simulation\CivilizationSim.o build\simulation\ConflictSystem.o build\simulation\LogisticsSystem.o build\simulation\UnitSystem.o build\environment\ChaosField.o build\environment\DisasterSystem.o build\environment\ClimateSim.o build\environment\HydrologySim.o %OBJ_COMMON% -o bin\TALEWEAVERS_Engine.exe %LIBS%
+%CXX% build\apps\App_Sim.o build\core\NeighborFinder.o build\biology\AgentSystem.o build\biology\InfluenceMap.o build\biology\HerdSystem.o build\simulation\CivilizationSim.o build\simulation\ConflictSystem.o build\simulation\LogisticsSystem.o build\simulation\UnitSystem.o build\simulation\FactionStats.o build\environment\ChaosField.o build\core\DiffusionSolver.o build\environment\DisasterSystem.o build\environment\ClimateSim.o build\environment\HydrologySim.o %OBJ_COMMON% -o bin\TALEWEAVERS_Engine.exe %LIBS%
 if !errorlevel! neq 0 ( echo [ERROR] Engine link failed. & exit /b 1 )
 goto :eof
 
@@ -1,6 +1,8 @@
 #pragma once
 #include "SagaConfig.hpp"
 #include "WorldEngine.hpp"
+#include <algorithm>
+#include <cstdint>
 #include <map>
 #include <string>
 #include <vector>
@@ -100,6 +102,130 @@ struct BiomeDef {
   float scarcity; // 0.0 = Common, 1.0 = Rare (Checked first)
 };
 
+// Lookup table compiled from biomeRegistry (AssetManager::CompileBiomeTable).
+// Axes are temperature [0,1], moisture [0,1] and elevation relative to sea
+// level: -1 = deepest floor, 0 = coast, +1 = highest peak (the BiomeDef
+// height range uses the same scale). Each axis is quantized to AXIS_RES
+// steps and remapped to the bands between the registry's range edges, so the
+// 3D table only has one entry per distinct combination and stays in L1.
+// Within a band the biomes whose ranges cover it compete, rarest first, then
+// the tightest range; bands no biome covers take the nearest range.
+struct BiomeTable {
+  static const int AXIS_RES = 1024;
+  static const int CHAOS_ID = -1; // biomeID of chaos-warped cells
+
+  // Quantized value -> band; height covers [-1,1], lower half underwater
+  std::vector<uint8_t> tempBand, moistBand, heightBand;
+  int tempBands = 1, moistBands = 1;
+  std::vector<uint8_t> cells; // [(height * moistBands + moist) * tempBands + temp]
+  std::vector<int> ids;       // Cell value -> BiomeDef::id
+
+  // Hysteresis support: per height band, a coarse MARGIN_RES^2 grid over
+  // temperature x moisture. A point that moves fewer grid steps (Chebyshev)
+  // than its step's margin keeps its biome; 0 = the step is on a boundary.
+  static const int MARGIN_RES = 128;
+  std::vector<uint8_t> margin; // [(height * MARGIN_RES + moist) * MARGIN_RES + temp]
+
+  int revision = 0; // Bumped on every compile
+
+  // Branch-free; 'underwater' pins the height to the matching half so cells
+  // right at sea level cannot flip sides
+  int HeightBand(float elevation, bool underwater) const {
+    const int R = AXIS_RES;
+    int h = (int)((elevation + 1.0f) * (0.5f * R));
+    h = std::min(underwater ? R / 2 - 1 : R - 1,
+                 std::max(underwater ? 0 : R / 2, h));
+    return heightBand[h];
+  }
+  int Classify(float temp, float moisture, int band) const {
+    const int R = AXIS_RES;
+    int t = std::min(R - 1, std::max(0, (int)(temp * R)));
+    int m = std::min(R - 1, std::max(0, (int)(moisture * R)));
+    return ids[cells[(band * moistBands + moistBand[m]) * tempBands +
+                     tempBand[t]]];
+  }
+  int Classify(float temp, float moisture, float elevation,
+               bool underwater) const {
+    return Classify(temp, moisture, HeightBand(elevation, underwater));
+  }
+  static int MarginStep(float v) {
+    return std::min(MARGIN_RES - 1, std::max(0, (int)(v * MARGIN_RES)));
+  }
+  int Margin(int band, int tempStep, int moistStep) const {
+    return margin[((size_t)band * MARGIN_RES + moistStep) * MARGIN_RES +
+                  tempStep];
+  }
+};
+
+// Flat copy of agentRegistry for the simulation hot loops, compiled by
+// AssetManager::CompileSpeciesTable. Species sit at their registry index in
+// parallel arrays; cells store agent IDs (cultureID), which Index() maps to
+// that index. Diet and output maps become dense MAX_RESOURCES rows, with a
+// bit per resource the map names (an explicit 0 still counts for food).
+struct SpeciesTable {
+  static constexpr int NONE = -1;
+  static constexpr int R = WorldBuffers::MAX_RESOURCES;
+  enum Flags : uint8_t {
+    FLORA = 1,
+    FAUNA = 2,
+    CIVILIZED = 4,
+    FARMABLE = 8,
+    DOMESTICATABLE = 16
+  };
+
+  std::vector<int> indexOfID; // Agent ID -> index (NONE = unknown ID)
+  std::vector<int> ids;       // Index -> agent ID
+  std::vector<uint8_t> flags;
+  // Survival window and optimum (CalculateDesire)
+  std::vector<float> tempLow, tempHigh, moistureLow, moistureHigh;
+  std::vector<float> idealTemp, idealMoisture;
+  std::vector<float> expansionRate, aggression;
+  std::vector<uint32_t> dietMask, outputMask; // Bit r = resource r listed
+  std::vector<float> diet, output;            // [index * R + resource]
+
+  int revision = 0; // Bumped on every compile
+
+  int Count() const { return (int)ids.size(); }
+  int Index(int id) const {
+    return (id >= 0 && id < (int)indexOfID.size()) ? indexOfID[id] : NONE;
+  }
+  bool Is(int index, uint8_t flag) const { return (flags[index] & flag) != 0; }
+  const float *Diet(int index) const { return diet.data() + (size_t)index * R; }
+  const float *Output(int index) const {
+    return output.data() + (size_t)index * R;
+  }
+};
+
+// --- 7. CALENDAR (calendar.json, edited in the Database app) ---
+struct CalendarSeason {
+  std::string name;
+  int startMonth; // 1-based
+  int startDay;   // 1-based
+};
+
+struct CalendarMoon {
+  std::string name;
+  float cycle; // Days per full cycle
+  float shift; // Day offset of the new moon
+};
+
+struct CalendarDef {
+  std::string name = "Default";
+  std::vector<int> monthLengths = std::vector<int>(12, 30);
+  std::vector<CalendarSeason> seasons = {{"Spring", 1, 1},
+                                         {"Summer", 4, 1},
+                                         {"Autumn", 7, 1},
+                                         {"Winter", 10, 1}};
+  std::vector<CalendarMoon> moons = {{"Moon", 28.0f, 0.0f}};
+
+  int DaysPerYear() const;
+  int SeasonStartDay(int season) const; // Day of year (0-based)
+  // Season containing 'day' plus the blend weight towards the next season
+  int SeasonAt(int day, int *nextSeason = nullptr,
+               float *blend = nullptr) const;
+  float MoonPhase(int moon, int day) const; // 0 = new, 0.5 = full
+};
+
 namespace AssetManager {
 // Registries
 extern std::vector<PointOfInterest> poiList;
@@ -111,13 +237,18 @@ extern std::vector<FactionData> factionRegistry;
 
 // NEW: Biomes
 extern std::vector<BiomeDef> biomeRegistry;
+extern BiomeTable biomeTable; // Rebuild with CompileBiomeTable after edits
 
 // NEW: Agent Definitions (for EditorUI)
 extern std::vector<AgentDefinition> agentRegistry;
+extern SpeciesTable speciesTable; // Rebuild with CompileSpeciesTable after edits
 
 // Mobile Units
 extern std::vector<Unit> activeUnits;
 
+// Calendar driving seasons / moons (defaults if calendar.json is missing)
+extern CalendarDef calendar;
+
 // Diplomacy Matrix: Key = "factionA_factionB", Value = -100 to +100
 extern std::map<std::string, float> diplomacyMatrix;
 
@@ -126,10 +257,16 @@ void Initialize();
 // IO Functions
 void LoadAll(const std::string &path = SagaConfig::RULES_JSON);
 void SaveAll(const std::string &path = SagaConfig::RULES_JSON);
+bool LoadCalendar(const std::string &path = SagaConfig::CALENDAR_JSON);
+void CompileBiomeTable();
+void CompileSpeciesTable();
+// Compiles the species table if agents were added or removed since
+const SpeciesTable &Species();
 
 // Simulation State Save/Load
 void SaveSimulationState(const std::string &path, const WorldBuffers &buffers,
                          const WorldSettings &settings);
+// Rewrites the layers in bulk: callers keeping FactionStats must Invalidate it
 void LoadSimulationState(const std::string &path, WorldBuffers &buffers,
                          WorldSettings &settings);
 
@@ -1,10 +1,19 @@
 #pragma once
 #include "WorldEngine.hpp"
+#include <iosfwd>
 #include <string>
 
 namespace BinaryExporter {
-void SaveWorld(const WorldBuffers &buffers, const std::string &filename);
-bool LoadWorld(WorldBuffers &buffers, const std::string &filename);
+// Optional section after the world layers, owned by a module the exporter
+// does not link (e.g. HydrologySim::WriteRivers / ReadRivers). Loading
+// without a reader ignores it.
+typedef void (*SectionWriter)(std::ostream &out);
+typedef bool (*SectionReader)(std::istream &in, uint32_t mapCells);
+
+void SaveWorld(const WorldBuffers &buffers, const std::string &filename,
+               SectionWriter extra = nullptr);
+bool LoadWorld(WorldBuffers &buffers, const std::string &filename,
+               SectionReader extra = nullptr);
 
 // Compact Snapshots (Excludes static terrain/climate)
 void SaveSnapshot(const WorldBuffers &buffers, const std::string &filename);
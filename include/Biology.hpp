@@ -5,9 +5,80 @@
 namespace AgentSystem {
 extern std::vector<AgentTemplate> speciesRegistry;
 void Initialize();
+// Flora and fauna tick: parallel metabolism and intents, then a serial
+// resolve; the result does not depend on SAGA_THREADS
 void UpdateBiology(WorldBuffers &b, const NeighborGraph &g,
                    const WorldSettings &s, const ChronosConfig &c);
 void SpawnLife(WorldBuffers &b, int count);
 void SpawnCivilization(WorldBuffers &b, int count);
 void UpdateCivilization(WorldBuffers &b, const NeighborGraph &g);
 } // namespace AgentSystem
+
+// Influence maps (src/biology/InfluenceMap.cpp)
+// Coarse scalar fields shared by agent decisions, rebuilt once per biology
+// tick: the block means of each quantity over CELL x CELL cells, box-blurred
+// by RADIUS blocks on the ThreadPool. Agents read them with one lookup
+// instead of scanning their neighbourhood.
+namespace InfluenceMap {
+enum Field {
+  PREY = 0,     // Population of non-predator fauna
+  THREAT,       // Population of predators (fauna with aggression > 0.5)
+  CIVILIZATION, // Population of civilized species
+  FOOD,         // Resource 0 in stock
+  FIELD_COUNT
+};
+static const int CELL = 4;   // Cells per block side
+static const int RADIUS = 2; // Blur radius in blocks
+
+void Update(const WorldBuffers &b);
+// Blurred value around a cell (0 before the first Update)
+float Sample(Field f, int cell);
+// Unit direction in which the field grows at a cell, in cell x/y (zero
+// where the field is flat)
+void Gradient(Field f, int cell, float &gx, float &gy);
+} // namespace InfluenceMap
+
+// Herds (src/biology/HerdSystem.cpp)
+// Optional entity layer for named herds and monsters that roam freely on top
+// of the cell layers. Components live in parallel arrays indexed by slot;
+// slots of despawned herds are recycled, and a handle's generation tells a
+// recycled slot from the herd that held it. Each Update steers every herd in
+// parallel chunks (influence maps, plus a spatial hash to keep herds apart),
+// then a serial sync moves head counts into cultureID/population in spatial
+// hash order, so results do not depend on SAGA_THREADS.
+namespace HerdSystem {
+struct Handle {
+  int slot = -1;
+  uint32_t generation = 0;
+};
+
+struct Components {
+  std::vector<float> x, y;           // Position in cells
+  std::vector<int> speciesID;        // Agent ID
+  std::vector<uint32_t> headcount;   // Animals in the herd
+  std::vector<uint32_t> generation;  // Bumped when the slot is freed
+  std::vector<uint8_t> alive;
+  std::vector<std::string> name;
+  // What the herd has written into the cell layers (-1 = nothing)
+  std::vector<int> syncedCell;
+  std::vector<uint32_t> syncedCount;
+};
+
+Handle Spawn(int speciesID, float x, float y, uint32_t headcount,
+             const std::string &name);
+// The herd's heads leave the cell layers on the next Update
+void Despawn(Handle h);
+bool Alive(Handle h);
+int Count(); // Live herds
+const Components &Get();
+
+// Splits up to 'count' herds off fauna cells drawn from CellRandom (heads
+// stay counted)
+void SpawnHerds(WorldBuffers &b, int count);
+void Update(WorldBuffers &b);
+// Forgets every herd without touching the cell layers
+void Clear();
+
+// Slots of live herds within 'radius' cells of (x, y), as of the last Update
+void Query(float x, float y, float radius, std::vector<int> &out);
+} // namespace HerdSystem
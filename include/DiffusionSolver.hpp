@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+
+// Unconditionally stable diffusion for scalar layers on the square cell grid
+// (src/core/DiffusionSolver.cpp).
+// Advances dc/dt = rate * (mean of the 8 neighbours - c) - decay * c by any
+// number of ticks in one backward-Euler step, solved with multigrid V-cycles.
+// The neighbour mean matches the explicit kernels (edge cells average over
+// the neighbours they have), so a 1-tick Solve is the implicit twin of one
+// explicit step and an N-tick Solve stands in for N of them at any N.
+// Not thread-safe (scratch levels are shared); the solve itself runs on the
+// ThreadPool.
+namespace DiffusionSolver {
+
+struct Params {
+  float rate = 0.1f;        // Share moved towards the neighbour mean per tick
+  float decay = 0.0f;       // Share lost per tick
+  float ticks = 1.0f;       // Step length
+  int maxCycles = 10;       // V-cycle budget
+  float tolerance = 1e-4f;  // Stop once max |residual| <= tolerance * max |c|
+};
+
+// field: side*side values, row-major, updated in place.
+// fixed (optional): cells that keep their value (sources / boundaries).
+// Returns the number of V-cycles run.
+int Solve(float *field, int side, const Params &p,
+          const uint8_t *fixed = nullptr);
+
+} // namespace DiffusionSolver
@@ -1,27 +1,124 @@
 #pragma once
 #include "WorldEngine.hpp"
+#include <iosfwd>
 
 // Climate Engine (src/environment/ClimateSim.cpp)
+// Base fields (latitude/altitude temperature, wind, orographic moisture) and
+// one seasonal table per calendar season (AssetManager::calendar) are baked
+// once and only re-baked when terrain, climate settings or the calendar
+// change. Update() blends the two seasons around ChronosConfig::dayCount and
+// adds the lunar tide and global modifiers.
+// WorldSettings::climateResolution > 1 bakes on a grid that many cells coarser
+// and upsamples each solve with per-cell altitude, season and tide.
+// climateIntervalDays > 0 skips solves until that many days have passed (or
+// terrain/settings changed); the buffers keep the last solve in between.
+// Biomes are reclassified incrementally: a cell keeps its biome until its
+// climate drifts past its distance to the nearest rule boundary (plus a
+// small hysteresis), its chaos state flips or its terrain changes.
 namespace ClimateSim {
+struct BiomeTransition {
+  uint32_t cell;
+  int from, to; // biomeID before / after (BiomeTable::CHAOS_ID for chaos)
+};
+
 void Update(WorldBuffers &b, const WorldSettings &s, const ChronosConfig &c);
-}
+void Bake(WorldBuffers &b, const WorldSettings &s); // Force a full re-bake
+// Height changed in [x0,x1) x [y0,y1) (or everywhere); re-baked lazily
+void MarkTerrainDirty(int x0, int y0, int x1, int y1);
+void MarkTerrainDirty();
+// Cells whose biome changed in the last Update, in cell order. Empty when
+// the solve was skipped, or when BiomesReset() is set: the whole map was
+// reclassified (first solve, new terrain or rules) and must be rescanned.
+const std::vector<BiomeTransition> &BiomeTransitions();
+bool BiomesReset();
+// Bumped by every solve that rewrote temperature and moisture (caches keyed
+// on climate compare against it)
+uint32_t SolveCount();
+} // namespace ClimateSim
 
 // Hydrology (src/environment/HydrologySim.cpp)
+// Each tick every land cell drains to its lowest neighbour (cached per tile,
+// re-routed where heights changed), then gathers the runoff sent to it.
+// Deterministic for any thread count. Fills flux with the water passing
+// through each cell (routed one cell per tick, swapped with nextFlux).
+// With riverFlowToOcean, routing runs over the terrain with every depression
+// filled to its spill level (Priority-Flood), so all land drains to the sea
+// or the map edge; the filled cells are written to lakeID as numbered lakes.
+// The fill is redone on the next tick after MarkTerrainDirty.
 namespace HydrologySim {
 void Update(WorldBuffers &b, const NeighborGraph &g, const WorldSettings &s);
+// One-shot flux: accumulates runoff down the receivers in height order,
+// giving the flux Update converges to (use after generation)
+void SolveFlow(WorldBuffers &b, const NeighborGraph &g, const WorldSettings &s);
+// Height changed in [x0,x1) x [y0,y1) (or everywhere); re-routed lazily
+void MarkTerrainDirty(int x0, int y0, int x1, int y1);
+void MarkTerrainDirty();
+// Per cell, the sink its water ends in (the cell itself for sinks).
+// Refreshed by SolveFlow.
+const std::vector<int> &Basins();
+// Per cell, the neighbour its water moves to (-1 = ocean or sink). Current
+// after Update / SolveFlow; empty before the first one.
+const std::vector<int> &Receivers();
+
+// --- RIVER NETWORK ---
+// Channels with flux >= WorldSettings::riverMinFlux, split into segments
+// between channel heads, confluences and mouths.
+struct RiverSegment {
+  uint32_t firstCell; // Slice of RiverNetwork::cells, upstream to downstream;
+  uint32_t cellCount; // the last cell is the confluence or sea cell it joins
+  int downstream;     // Segment it flows into (-1 = mouth)
+  int order;          // Strahler order
+  int source;         // Head cell of its longest-flowing headwater
+  int mouth;          // Last cell of the river it belongs to
+  int basin;          // Sink cell the river drains to (see Basins())
+  float flux;         // Flux where it leaves its last channel cell
+};
+struct RiverNetwork {
+  std::vector<RiverSegment> segments; // Ordered by first cell
+  std::vector<uint32_t> cells;
+};
+// Traces the network from the current receivers and flux (after SolveFlow)
+void ExtractRivers(const WorldBuffers &b, const WorldSettings &s);
+// Last extracted (or loaded) network
+RiverNetwork &Rivers();
+// The network as a trailing world file section (pass to
+// BinaryExporter::SaveWorld / LoadWorld). ReadRivers leaves the network
+// empty and returns false when the section is missing, truncated or out of
+// range for a map of mapCells cells.
+void WriteRivers(std::ostream &out);
+bool ReadRivers(std::istream &in, uint32_t mapCells);
 }
 
 // ChaosField namespace (src/environment/ChaosField.cpp)
+// Update diffuses chaos in parallel into nextChaos and swaps the buffers;
+// mutants then spawn on hot cells from CellRandom, so a run is reproducible
+// for a given seed and thread count does not matter.
+// Only 32x32 tiles holding chaos (and the ring around them) are diffused;
+// the rest is kept at zero. Code that raises chaos outside Update must call
+// MarkActive on the cell (or MarkAllActive after bulk writes).
+// WorldSettings::chaosIntervalTicks > 1 skips calls until that many ticks
+// have passed, then advances them in one implicit DiffusionSolver step with
+// the sources stamped at that call's convergence angle.
 namespace ChaosField {
 void SpawnRift(WorldBuffers &b, int index, float intensity);
 void ClearRifts();
 void Update(WorldBuffers &b, const NeighborGraph &g, const WorldSettings &s);
+void MarkActive(int index);
+void MarkAllActive();
 } // namespace ChaosField
 
 // Disaster System (src/environment/DisasterSystem.cpp)
+// Earthquakes, tornadoes, hurricanes and droughts hit their footprint once;
+// the ones spawned in a tick are applied in one batch (precomputed falloff
+// discs, parallel over rows). Spawns are logged to LoreScribeNS as DISASTER.
+// Tsunamis (1), wildfires (4) and floods (5) start an event that Update
+// advances every tick from its frontier: fire spreads over flora unless the
+// ground is wet, floods follow HydrologySim::Receivers() and spill onto low
+// banks, tsunamis cross the sea and run inland while the wave tops the land.
 namespace DisasterSystem {
 void Update(WorldBuffers &b, const WorldSettings &s);
 void Trigger(WorldBuffers &b, int type, int index, float strength);
+void ClearEvents(); // Drops running events (new map)
 } // namespace DisasterSystem
 
 // ChaosField (Free function - legacy wrapper)
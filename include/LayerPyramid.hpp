@@ -0,0 +1,59 @@
+#pragma once
+#include "WorldEngine.hpp"
+
+// Multi-resolution mip chain over selected WorldBuffers layers
+// (src/core/LayerPyramid.cpp).
+// Level 0 is the full grid and is read straight from the buffers; level L has
+// half the side of level L-1 (rounded up). Float layers store the mean of the
+// 2x2 children, the faction layer stores their mode.
+// Writers flag what they touched with MarkDirty*; Update() then rebuilds only
+// the affected tiles on every level. Mark/Update are not thread-safe and must
+// be called from the simulation thread, outside of parallel kernels.
+namespace LayerPyramid {
+
+enum Layer {
+  LAYER_HEIGHT = 0,
+  LAYER_TEMPERATURE,
+  LAYER_MOISTURE,
+  LAYER_POPULATION, // Mean people per cell (multiply by area for totals)
+  LAYER_FACTION,    // Dominant factionID (mode)
+  LAYER_COUNT
+};
+
+static const int TILE_SIZE = 32; // Dirty-tracking granularity (cells per side)
+static const int MIN_SIDE = 8;   // Coarsest level is at least this wide
+
+// --- MAINTENANCE ---
+// (Re)allocates the chain for b and rebuilds every level
+void Build(const WorldBuffers &b);
+// Flags level-0 cells [x0,x1) x [y0,y1) of a layer as changed
+void MarkDirty(Layer layer, int x0, int y0, int x1, int y1);
+void MarkLayerDirty(Layer layer);
+void MarkAllDirty();
+// Rebuilds dirty tiles (calls Build if b no longer matches the chain)
+void Update(const WorldBuffers &b);
+
+// --- QUERIES ---
+int Levels(); // 0 until Build has run
+int Side(int level);
+// Level that has roughly one cell per 'cellsPerSample' full-res cells
+int LevelForScale(float cellsPerSample);
+
+// Coordinates are in the level's own grid and clamped to it
+float Sample(Layer layer, int level, int x, int y);
+int SampleFaction(int level, int x, int y);
+// u,v in [0,1]; bilinear on float layers
+float SampleUV(Layer layer, int level, float u, float v);
+
+// Mean / dominant faction over full-res cells [x0,x1) x [y0,y1), answered
+// from the coarsest level that still resolves the region. The mean weights
+// border cells by overlap; the faction vote is per coarse cell.
+float RegionMean(Layer layer, int x0, int y0, int x1, int y1);
+int RegionFaction(int x0, int y0, int x1, int y1);
+
+// Raw level storage (level >= 1), Side(level)^2 entries, row-major.
+// Data() returns nullptr for LAYER_FACTION, FactionData() for level 0.
+const float *Data(Layer layer, int level);
+const int *FactionData(int level);
+
+} // namespace LayerPyramid
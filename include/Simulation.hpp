@@ -15,6 +15,37 @@ void ConstructBuildings(WorldBuffers &b);
 void ProduceResources(WorldBuffers &b);
 } // namespace CivilizationSim
 
+// FactionStats (src/simulation/FactionStats.cpp)
+// Running totals per faction, i.e. per civilized species index in the compiled
+// table (the way CivilizationSim groups cells). Systems that change a
+// civilized cell's culture, population, structure or wealth bracket the write
+// with Leave/Enter, or report a wealth change with AddWealth, so reads are
+// O(1) instead of a map scan. Bulk writers (loads, editors) call Invalidate;
+// Ensure then rebuilds from the layers in parallel.
+namespace FactionStats {
+struct Totals {
+  int64_t population = 0;
+  int cells = 0;
+  int structures = 0; // Sum of structureType levels
+  double wealth = 0.0;
+};
+
+void Leave(const WorldBuffers &b, int cell); // Before writing the cell
+void Enter(const WorldBuffers &b, int cell); // After writing it
+void AddWealth(const WorldBuffers &b, int cell, float delta);
+// Zero for non-civilized species or before the first Ensure
+const Totals &Of(int speciesIndex);
+
+void Invalidate();
+void Ensure(const WorldBuffers &b); // Rebuilds if stale
+void Rebuild(const WorldBuffers &b);
+// Checks the running totals against a rebuild, logs any drift and adopts
+// the rebuilt ones
+bool Validate(const WorldBuffers &b);
+// Copies the totals into FactionData::totalPopulation / totalCells
+void Publish();
+} // namespace FactionStats
+
 // ConflictSystem (src/simulation/ConflictSystem.cpp)
 namespace ConflictSystem {
 void Update(WorldBuffers &b, const NeighborGraph &g, const WorldSettings &s);
@@ -0,0 +1,19 @@
+#pragma once
+#include <functional>
+
+// Shared worker pool for the simulation kernels
+// (src/core/ThreadPool.cpp)
+namespace ThreadPool {
+// Number of threads that take part in a ParallelFor (workers + caller)
+int WorkerCount();
+
+// Splits [begin, end) into contiguous chunks of 'grain' items and runs
+// fn(chunkBegin, chunkEnd) across the pool. Blocks until every chunk is done.
+// Chunk boundaries only depend on 'grain', never on the thread count, so
+// per-chunk results are reproducible. Nested calls run serially.
+void ParallelFor(int begin, int end, int grain,
+                 const std::function<void(int, int)> &fn);
+
+// Stops and joins the workers (optional, called at shutdown)
+void Shutdown();
+} // namespace ThreadPool
@@ -173,7 +173,8 @@ enum MapTemplate {
   TEMPLATE_SINGLE_LANDMASS,
   TEMPLATE_TWIN_LANMASSES,
   TEMPLATE_BROKEN,
-  TEMPLATE_CUSTOM
+  TEMPLATE_CUSTOM,
+  TEMPLATE_TECTONIC // Plate-boundary relief (GenerateTectonicPlates)
 };
 
 // 1. World Configuration (Linked to God Mode UI)
@@ -201,6 +202,10 @@ struct WorldSettings {
   // 3. Domain Warping (Alien/Fluid Look)
   float warpStrength = 1.0f; // Distortion amount
 
+  // 4. Plate Tectonics (TEMPLATE_TECTONIC)
+  int plateCount = 12; // Number of crustal plates to seed
+  int plateSteps = 8;  // Crust drift steps over the boundaries
+
   // --- Physics Controls ---
   float heightSeverity =
       1.0f; // Exponent for slope steepness (NOT used for warp)
@@ -226,11 +231,14 @@ struct WorldSettings {
   float globalTemp = 0.0f;  // -1.0 (Ice Age) to +1.0 (Global Warming)
   float windAngle = 0.785f; // Radians (approx 45 degrees / NE)
   float raininess = 1.0f;   // Rainfall multiplier
+  int climateResolution = 1;   // Climate grid step: 1 = full res, 4/8 = coarse
+  int climateIntervalDays = 0; // Days between climate solves (0 = every call)
 
   // River Controls
   int riverCount = 50;
   float riverMaxSize = 5.0f;    // Max width/volume
-  bool riverFlowToOcean = true; // Force routing
+  bool riverFlowToOcean = true; // Route over filled depressions (lakes)
+  float riverMinFlux = 1.0f;    // Flux at which a channel becomes a river
   bool showIce = true;
 
   // Island Mode
@@ -265,6 +273,7 @@ struct WorldSettings {
   bool enableFactions = true;
   bool enableBiology = true;  // Simulate vegetation/wildlife
   bool enableConflict = true; // Enable war/border pushing
+  bool enableHerds = false;   // Roaming herds (HerdSystem), SAGA_HERDS=1
 
   // Simulation Controls
   int timeScale = 1;
@@ -273,6 +282,7 @@ struct WorldSettings {
 
   float mutantSpawnChance = 0.001f;
   float convergenceAngle = 0.0f;
+  int chaosIntervalTicks = 1; // Ticks per chaos solve (> 1 = implicit step)
 
   // Tracked Settlements
   std::vector<SettlementDefinition> globalSettlements;
@@ -293,6 +303,7 @@ struct WorldBuffers {
   float *windDY = nullptr;   // Wind Vector Y
   float *flux = nullptr;     // River/Water accumulation volume (READ buffer)
   float *nextFlux = nullptr; // Double-buffer for water (WRITE buffer)
+  int *lakeID = nullptr;     // Filled depression label (0 = none), HydrologySim
 
   // Civilization & Life
   int *factionID = nullptr;
@@ -300,6 +311,7 @@ struct WorldBuffers {
       nullptr; // Species/ethnicity (separate from political faction)
   uint32_t *population = nullptr;
   float *chaos = nullptr;
+  float *nextChaos = nullptr; // ChaosField write buffer (swapped with chaos)
   float *infrastructure = nullptr; // Roads/Cities
   float *wealth = nullptr;         // Accumulated resources (Food/Iron/Gold)
 
@@ -343,6 +355,7 @@ struct WorldBuffers {
     cultureID = new int[count];
     population = new uint32_t[count];
     chaos = new float[count];
+    nextChaos = new float[count];
     infrastructure = new float[count];
 
     // Zero out memory
@@ -350,6 +363,7 @@ struct WorldBuffers {
     std::fill_n(cultureID, count, -1);
     std::fill_n(population, count, 0);
     std::fill_n(chaos, count, 0.0f);
+    std::fill_n(nextChaos, count, 0.0f);
     std::fill_n(infrastructure, count, 0.0f);
     std::fill_n(temperature, count, 0.0f);
     std::fill_n(moisture, count, 0.0f);
@@ -379,6 +393,8 @@ struct WorldBuffers {
     std::fill_n(flux, count, 0.0f);     // Zero it out
     nextFlux = new float[count];        // Allocate NextFlux
     std::fill_n(nextFlux, count, 0.0f); // Zero it out
+    lakeID = new int[count];
+    std::fill_n(lakeID, count, 0);
 
     // Economy layer
     civTier = new int[count];
@@ -411,12 +427,14 @@ struct WorldBuffers {
     delete[] cultureID;
     delete[] population;
     delete[] chaos;
+    delete[] nextChaos;
     delete[] infrastructure;
     delete[] wealth;
     delete[] structureType;
     delete[] defense;
     delete[] flux;
     delete[] nextFlux;
+    delete[] lakeID;
     delete[] civTier;
     delete[] buildingID;
     delete[] resourceInventory;
@@ -460,13 +478,32 @@ struct ChronosConfig {
   int daysPerMonth = 30;
   float currentDayProgress = 0.0f;
   int globalTimeScale = 1; // 0 = Pause
-  int currentSeason = 0; // 0=Spring, 1=Summer, 2=Autumn, 3=Winter
+  int currentSeason = 0; // Index into AssetManager::calendar.seasons
   float moonPhase = 0.0f; // 0.0 to 1.0
   int daysPerSeason = 90;
   int daysPerMoonCycle = 28;
 };
 
-// 4. Neighbor Graph (Added for Modules)
+// 4. Deterministic Randomness
+// Parallel kernels can't share rand(): draw from a hash of the cell, the tick
+// and a per-system stream instead, so every cell gets the same value on any
+// thread count and in any visiting order.
+inline uint32_t HashMix(uint32_t h) {
+  h ^= h >> 16;
+  h *= 0x7FEB352Du;
+  h ^= h >> 15;
+  h *= 0x846CA68Bu;
+  h ^= h >> 16;
+  return h;
+}
+
+// Uniform in [0, 1)
+inline float CellRandom(uint32_t cell, uint32_t tick, uint32_t stream) {
+  uint32_t h = HashMix(stream + HashMix(tick + HashMix(cell)));
+  return (float)(h >> 8) * (1.0f / 16777216.0f);
+}
+
+// 5. Neighbor Graph (Added for Modules)
 struct NeighborGraph {
   int *neighborData = nullptr;
   int *offsetTable = nullptr;
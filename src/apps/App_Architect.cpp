@@ -70,34 +70,16 @@ BiomeColor GetBiomeColor(int biomeID, float height, float seaLevel) {
     return {5, 40, 100};    // Deep
   }
 
-  switch (biomeID) {
-  case BiomeType::SNOW:
-    return {240, 240, 255};
-  case BiomeType::TUNDRA:
-    return {180, 190, 180};
-  case BiomeType::BARE:
-    return {130, 130, 130};
-  case BiomeType::SCORCHED:
-    return {90, 80, 70};
-  case BiomeType::TROPICAL_RAIN_FOREST:
-    return {20, 100, 40};
-  case BiomeType::TROPICAL_SEASONAL_FOREST:
-    return {50, 120, 50};
-  case BiomeType::TEMPERATE_RAIN_FOREST:
-    return {40, 140, 80};
-  case BiomeType::TEMPERATE_DECIDUOUS_FOREST:
-    return {70, 160, 60};
-  case BiomeType::GRASSLAND:
-    return {120, 180, 80};
-  case BiomeType::SHRUBLAND:
-    return {140, 160, 100};
-  case BiomeType::SUBTROPICAL_DESERT:
-    return {210, 180, 100};
-  case BiomeType::TEMPERATE_DESERT:
-    return {190, 170, 130};
-  default:
-    return {60, 140, 60}; // Default Lush
+  // Land takes the rules color of its biome (AssetManager::biomeRegistry)
+  if (biomeID == BiomeTable::CHAOS_ID)
+    return {150, 40, 170};
+  for (const BiomeDef &def : AssetManager::biomeRegistry) {
+    if (def.id == biomeID)
+      return {(unsigned char)(def.color[0] * 255.0f),
+              (unsigned char)(def.color[1] * 255.0f),
+              (unsigned char)(def.color[2] * 255.0f)};
   }
+  return {60, 140, 60}; // Default Lush
 }
 
 // --- TEXTURE GENERATOR ---
@@ -158,6 +140,7 @@ void UpdateMapTexture() {
 void Setup() {
   buffers.Initialize(1000 * 1000);
   LoreManager::Load();
+  AssetManager::Initialize(); // Biome rules drive the map colors
   TerrainController::GenerateHeightmap(buffers, settings);
   ClimateSim::Update(buffers, settings, clockConfig);
   UpdateMapTexture();
@@ -243,9 +226,9 @@ void DrawTools() {
 
       const char *templateNames[] = {
           "Random",          "Continents", "Island Chain", "Single Landmass",
-          "Twin Landmasses", "Broken",     "Custom"};
+          "Twin Landmasses", "Broken",     "Custom",       "Tectonic"};
       int currentType = (int)settings.worldType;
-      if (ImGui::Combo("World Template", &currentType, templateNames, 7)) {
+      if (ImGui::Combo("World Template", &currentType, templateNames, 8)) {
         settings.worldType = (MapTemplate)currentType;
         TerrainController::GenerateHeightmap(buffers, settings);
         mapDirty = true;
@@ -256,6 +239,11 @@ void DrawTools() {
         mapDirty = true;
       }
 
+      if (settings.worldType == TEMPLATE_TECTONIC) {
+        ImGui::SliderInt("Plates", &settings.plateCount, 2, 64);
+        ImGui::SliderInt("Geological Steps", &settings.plateSteps, 1, 32);
+      }
+
       if (ImGui::Button("Generate Tectonic Plates", ImVec2(-1, 30))) {
         TerrainController::GenerateTectonicPlates(buffers, settings);
         mapDirty = true;
@@ -289,6 +277,14 @@ void DrawTools() {
       if (ImGui::SliderFloat("Global Moisture", &settings.raininess, 0.0f,
                              3.0f))
         mapDirty = true;
+      const char *gridNames[] = {"Full", "4x Coarse", "8x Coarse"};
+      int gridIdx = settings.climateResolution >= 8   ? 2
+                    : settings.climateResolution >= 4 ? 1
+                                                      : 0;
+      if (ImGui::Combo("Climate Grid", &gridIdx, gridNames, 3)) {
+        settings.climateResolution = (gridIdx == 0) ? 1 : (gridIdx == 1 ? 4 : 8);
+        mapDirty = true;
+      }
 
       ImGui::Separator();
       ImGui::Text("Temperature Zones");
@@ -351,7 +347,8 @@ void DrawTools() {
       }
       ImGui::Separator();
       if (ImGui::Button("Save Current World (world.map)", ImVec2(-1, 40))) {
-        BinaryExporter::SaveWorld(buffers, "data/world.map");
+        BinaryExporter::SaveWorld(buffers, "data/world.map",
+                                  HydrologySim::WriteRivers);
       }
       ImGui::EndTabItem();
     }
@@ -380,18 +377,27 @@ void DrawTools() {
 
             const char *typeNames[] = {"Flora", "Fauna", "Civilized"};
             int type = (int)a.type;
-            if (ImGui::Combo("Type", &type, typeNames, 3))
+            bool speciesChanged = false;
+            if (ImGui::Combo("Type", &type, typeNames, 3)) {
               a.type = (AgentType)type;
+              speciesChanged = true;
+            }
 
-            ImGui::SliderFloat("Ideal Temp", &a.idealTemp, 0.0f, 1.0f);
+            speciesChanged |=
+                ImGui::SliderFloat("Ideal Temp", &a.idealTemp, 0.0f, 1.0f);
             ImGui::SliderFloat("Resilience", &a.resilience, 0.0f, 1.0f);
-            ImGui::SliderFloat("Aggression", &a.aggression, 0.0f, 1.0f);
-            ImGui::SliderFloat("Expansion", &a.expansionRate, 0.0f, 1.0f);
+            speciesChanged |=
+                ImGui::SliderFloat("Aggression", &a.aggression, 0.0f, 1.0f);
+            speciesChanged |=
+                ImGui::SliderFloat("Expansion", &a.expansionRate, 0.0f, 1.0f);
             ImGui::ColorEdit3("Map Color", a.color);
+            if (speciesChanged)
+              AssetManager::CompileSpeciesTable();
 
             if (ImGui::Button("Delete Species")) {
               AssetManager::agentRegistry.erase(
                   AssetManager::agentRegistry.begin() + i);
+              AssetManager::CompileSpeciesTable();
               ImGui::TreePop();
               ImGui::PopID();
               break;
@@ -15,6 +15,7 @@
 #include "../../include/BinaryExporter.hpp"
 #include "../../include/Biology.hpp"
 #include "../../include/Environment.hpp"
+#include "../../include/LayerPyramid.hpp"
 #include "../../include/Lore.hpp"
 #include "../../include/SagaConfig.hpp"
 #include "../../include/Simulation.hpp"
@@ -37,6 +38,15 @@ void ExportStoryHooks(const WorldBuffers &buffers, const std::string &path) {
       json hook;
       hook["location"] = {(float)(i % side), (float)i / (float)side};
       hook["type"] = isWar ? "WAR_FRONT" : "FAMINE";
+
+      // Surrounding 32x32 region, read from the layer pyramid
+      int x = i % side, y = i / side;
+      hook["region"] = {
+          {"faction", LayerPyramid::RegionFaction(x - 16, y - 16, x + 16,
+                                                  y + 16)},
+          {"population",
+           LayerPyramid::RegionMean(LayerPyramid::LAYER_POPULATION, x - 16,
+                                    y - 16, x + 16, y + 16)}};
       hooks.push_back(hook);
 
       // Skip nearby cells to avoid spamming the same event
@@ -45,6 +55,21 @@ void ExportStoryHooks(const WorldBuffers &buffers, const std::string &path) {
     }
   }
 
+  // Major rivers, read from the vector network instead of the flux raster
+  for (const HydrologySim::RiverSegment &seg : HydrologySim::Rivers().segments) {
+    if (seg.downstream != -1 || seg.order < 3)
+      continue;
+    json hook;
+    hook["location"] = {(float)(seg.mouth % side), (float)(seg.mouth / side)};
+    hook["type"] = "RIVER_MOUTH";
+    hook["river"] = {
+        {"order", seg.order},
+        {"source", {(float)(seg.source % side), (float)(seg.source / side)}},
+        {"basin", seg.basin},
+        {"flux", seg.flux}};
+    hooks.push_back(hook);
+  }
+
   std::ofstream file(path);
   if (file.is_open()) {
     file << hooks.dump(4);
@@ -73,8 +98,11 @@ void ApplyWorldEdits(WorldBuffers &b, const std::string &path) {
 
         if (idx >= 0 && idx < (int)b.count) {
           b.agentStrength[idx] *= (1.0f - amt);
+          FactionStats::Leave(b, idx);
           b.population[idx] = (uint32_t)(b.population[idx] * (1.0f - amt));
+          FactionStats::Enter(b, idx);
           b.chaos[idx] = std::min(1.0f, b.chaos[idx] + amt);
+          ChaosField::MarkActive(idx);
 
           std::cout << "[ORACLE] Applied casualty at " << x << "," << y
                     << " (Chaos: " << b.chaos[idx] << ")\n";
@@ -114,6 +142,9 @@ int main() {
   WorldBuffers buffers;
   buffers.Initialize(1000000); // 1 Million Cells
   WorldSettings settings;
+  // SAGA_HERDS=1 adds the roaming herd layer (HerdSystem), off by default
+  const char *herds = std::getenv("SAGA_HERDS");
+  settings.enableHerds = herds && std::atoi(herds) > 0;
   NeighborGraph graph;
   NeighborFinder finder;
 
@@ -133,9 +164,10 @@ int main() {
 
   std::cout << "[LOG] Loading S.A.G.A. Map (" << SagaConfig::DATA_HUB
             << "world.map)...\n";
-  if (!BinaryExporter::LoadWorld(buffers, "bin/data/world.map")) {
-    if (!BinaryExporter::LoadWorld(buffers,
-                                   SagaConfig::DATA_HUB + "world.map")) {
+  if (!BinaryExporter::LoadWorld(buffers, "bin/data/world.map",
+                                 HydrologySim::ReadRivers)) {
+    if (!BinaryExporter::LoadWorld(buffers, SagaConfig::DATA_HUB + "world.map",
+                                   HydrologySim::ReadRivers)) {
       std::cout << "[ERROR] Could find S.A.G.A. world data! Run Architect "
                    "first.\n";
       return -1;
@@ -149,6 +181,8 @@ int main() {
   std::cout << "[LOG] Engine Hot and Ready. Seeding world...\n";
   AgentSystem::SpawnLife(buffers, 2000);       // 2000 flora/fauna nodes
   AgentSystem::SpawnCivilization(buffers, 25); // 25 starting civilizations
+  if (settings.enableHerds)
+    HerdSystem::SpawnHerds(buffers, 200);
 
   // Jumpstart Economy: Give every cell some starting food/wood/stone
   for (uint32_t i = 0; i < buffers.count; ++i) {
@@ -161,11 +195,20 @@ int main() {
   }
   std::cout << "[LOG] Seeding complete and economy jumpstarted. Entering "
                "simulation loop.\n\n";
+  LayerPyramid::Build(buffers);
+  FactionStats::Rebuild(buffers);
 
   // 3. Simulation Loop
     int totalYears = 100; // Historical Simulation Run
   int ticksPerYear = 12;
 
+  // Climate is smooth and slow: solve it on a 4x grid once per season
+  const CalendarDef &calendar = AssetManager::calendar;
+  settings.climateResolution = 4;
+  settings.climateIntervalDays =
+      std::max(1, calendar.DaysPerYear() /
+                      std::max(1, (int)calendar.seasons.size()));
+
   std::cout << "[SIM] Starting simulation run (" << totalYears
             << " years)...\n";
 
@@ -173,7 +216,8 @@ int main() {
   ChronosConfig clockConfig;
 
   // Save base terrain for history playback
-  BinaryExporter::SaveWorld(buffers, SagaConfig::DATA_HUB + "history/terrain.map");
+  BinaryExporter::SaveWorld(buffers, SagaConfig::DATA_HUB + "history/terrain.map",
+                            HydrologySim::WriteRivers);
 
   for (int year = 1; year <= totalYears; ++year) {
     LoreScribeNS::currentYear = year;
@@ -182,15 +226,21 @@ int main() {
     for (int month = 1; month <= ticksPerYear; ++month) {
       settings.convergenceAngle += 0.05f; // shift chaos paths over time
       if (settings.convergenceAngle > 3.14159f * 2.0f) settings.convergenceAngle -= 3.14159f * 2.0f;
-      clockConfig.dayCount += 30; // approx 30 days per month
-      clockConfig.currentSeason = (clockConfig.dayCount / clockConfig.daysPerSeason) % 4;
-      clockConfig.moonPhase = fmod((float)clockConfig.dayCount / clockConfig.daysPerMoonCycle, 1.0f);
+      // One simulated year spans one calendar year: the day comes from the
+      // year and month, so the truncated month length never accumulates
+      const CalendarDef &cal = AssetManager::calendar;
+      clockConfig.dayCount = (year - 1) * cal.DaysPerYear() +
+                             month * cal.DaysPerYear() / ticksPerYear;
+      clockConfig.currentSeason = cal.SeasonAt(clockConfig.dayCount);
+      clockConfig.moonPhase = cal.MoonPhase(0, clockConfig.dayCount);
       ClimateSim::Update(buffers, settings, clockConfig);
       ChaosField::Update(buffers, graph, settings);
       HydrologySim::Update(buffers, graph, settings);
       DisasterSystem::Update(buffers, settings);
 
       AgentSystem::UpdateBiology(buffers, graph, settings, clockConfig);
+      if (settings.enableHerds)
+        HerdSystem::Update(buffers);
       LogisticsSystem::Update(buffers, graph);
       ConflictSystem::Update(buffers, graph, settings);
 
@@ -203,6 +253,14 @@ int main() {
       CivilizationSim::Update(buffers, graph, settings);
     }
 
+    // Faction totals are kept by deltas; check them against a full count
+    FactionStats::Validate(buffers);
+
+    // Civ layers are written all over the place; refresh them once a year
+    LayerPyramid::MarkLayerDirty(LayerPyramid::LAYER_POPULATION);
+    LayerPyramid::MarkLayerDirty(LayerPyramid::LAYER_FACTION);
+    LayerPyramid::Update(buffers);
+
     // Save snapshot every 5 years (Optimized for space)
     if (year % 5 == 0) {
       std::string snapshotName =
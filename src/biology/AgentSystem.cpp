@@ -1,6 +1,9 @@
 #include "../../include/AssetManager.hpp"
 #include "../../include/Biology.hpp"
+#include "../../include/Environment.hpp"
 #include "../../include/Lore.hpp"
+#include "../../include/Simulation.hpp"
+#include "../../include/ThreadPool.hpp"
 #include <algorithm>
 #include <cmath>
 #include <iostream>
@@ -38,39 +41,219 @@ void Initialize() {
   // No specific initialization needed for now
 }
 
-// --- HELPER: SCORING ---
-float CalculateDesire(int cellIdx, const AgentDefinition &dna,
-                      const WorldBuffers &b) {
-  float temp = b.temperature[cellIdx];
-  float moisture = b.moisture[cellIdx];
+// --- SPECIES BUCKETS ---
+// Occupied cells grouped by species index, in cell order within a bucket.
+// Kernels walk one species at a time, so that species' constants stay in
+// registers and flora, fauna and civilized logic never interleave.
+struct Buckets {
+  std::vector<std::vector<int>> bySpecies;
+};
+
+// Buckets the cells [lo, hi) whose species has any of the type flags
+static void FillBuckets(const WorldBuffers &b, const SpeciesTable &t, int lo,
+                        int hi, uint8_t types, Buckets &out) {
+  out.bySpecies.resize(t.Count());
+  for (auto &cells : out.bySpecies)
+    cells.clear();
+  const int *culture = b.cultureID;
+  for (int i = lo; i < hi; ++i) {
+    if (culture[i] == -1)
+      continue;
+    int k = t.Index(culture[i]);
+    if (k != SpeciesTable::NONE && (t.flags[k] & types))
+      out.bySpecies[k].push_back(i);
+  }
+}
 
-  // Temperature check
-  if (temp < dna.deadlyTempLow || temp > dna.deadlyTempHigh)
-    return 0.0f;
-  // Moisture check
-  if (moisture < dna.deadlyMoistureLow || moisture > dna.deadlyMoistureHigh)
-    return 0.0f;
+// --- HABITAT CACHE ---
+// The climate half of CalculateDesire per wild species, one byte per cell:
+// 0 = outside the survival window, 1..255 = biome score 0..1. Tiles are
+// scored lazily where living cells look, and go stale only with a new climate
+// solve (ClimateSim::SolveCount) or species table; moisture moved by
+// hydrology or disasters in between waits for the next solve.
+static const int HABITAT_TILE = 32;
+struct Habitat {
+  std::vector<uint8_t> score;  // Per cell, empty until the species is seen
+  std::vector<uint32_t> stamp; // Per tile: SolveCount + 1 when scored
+  std::vector<uint8_t> flow;   // Fauna only, see FLOW FIELDS
+  uint32_t flowKey = 0;        // SolveCount + 1 when the flow was built
+};
+static std::vector<Habitat> habitats; // By species index
+static std::vector<std::pair<int, int>> staleTiles; // (species, tile)
+static int habitatRevision = -1;
+static int habitatSide = 0, habitatTilesX = 0;
+
+static void ScoreTile(const WorldBuffers &b, const SpeciesTable &t, int k,
+                      int tile) {
+  int side = habitatSide;
+  int x0 = (tile % habitatTilesX) * HABITAT_TILE;
+  int y0 = (tile / habitatTilesX) * HABITAT_TILE;
+  int x1 = std::min(side, x0 + HABITAT_TILE);
+  int y1 = std::min(side, y0 + HABITAT_TILE);
+  float tLow = t.tempLow[k], tHigh = t.tempHigh[k];
+  float mLow = t.moistureLow[k], mHigh = t.moistureHigh[k];
+  float tIdeal = t.idealTemp[k], mIdeal = t.idealMoisture[k];
+  uint8_t *score = habitats[k].score.data();
+  for (int y = y0; y < y1; ++y) {
+    for (int x = x0; x < x1; ++x) {
+      int i = y * side + x;
+      float temp = b.temperature[i];
+      float moisture = b.moisture[i];
+      if (temp < tLow || temp > tHigh || moisture < mLow || moisture > mHigh) {
+        score[i] = 0;
+        continue;
+      }
+      float biomeScore =
+          1.0f - (std::abs(temp - tIdeal) + std::abs(moisture - mIdeal)) * 2.0f;
+      score[i] = (uint8_t)(1.5f + std::max(0.0f, biomeScore) * 254.0f);
+    }
+  }
+}
 
-  float tempDiff = std::abs(temp - dna.idealTemp);
-  float moistureDiff = std::abs(moisture - dna.idealMoisture);
+// Scores the stale tiles under and around the bucketed cells
+static void RefreshHabitats(const WorldBuffers &b, const SpeciesTable &t,
+                            const std::vector<Buckets> &living) {
+  int side = (int)std::sqrt(b.count);
+  if (habitatRevision != t.revision || habitatSide != side) {
+    habitats.assign(t.Count(), Habitat());
+    habitatRevision = t.revision;
+    habitatSide = side;
+    habitatTilesX = (side + HABITAT_TILE - 1) / HABITAT_TILE;
+  }
+  uint32_t key = ClimateSim::SolveCount() + 1;
+  staleTiles.clear();
+  for (const Buckets &chunk : living) {
+    for (int k = 0; k < (int)chunk.bySpecies.size(); ++k) {
+      const std::vector<int> &cells = chunk.bySpecies[k];
+      if (cells.empty())
+        continue;
+      Habitat &h = habitats[k];
+      if (h.score.empty()) {
+        h.score.assign(b.count, 0);
+        h.stamp.assign((size_t)habitatTilesX * habitatTilesX, 0);
+      }
+      if (t.Is(k, SpeciesTable::FAUNA))
+        continue; // The flow field scores the whole map
+      for (int i : cells) {
+        int x = i % side, y = i / side;
+        int tx0 = std::max(0, x - 1) / HABITAT_TILE;
+        int tx1 = std::min(side - 1, x + 1) / HABITAT_TILE;
+        int ty0 = std::max(0, y - 1) / HABITAT_TILE;
+        int ty1 = std::min(side - 1, y + 1) / HABITAT_TILE;
+        for (int ty = ty0; ty <= ty1; ++ty)
+          for (int tx = tx0; tx <= tx1; ++tx) {
+            int tile = ty * habitatTilesX + tx;
+            if (h.stamp[tile] != key) {
+              h.stamp[tile] = key;
+              staleTiles.push_back({k, tile});
+            }
+          }
+      }
+    }
+  }
+  ThreadPool::ParallelFor(0, (int)staleTiles.size(), 4, [&](int lo, int hi) {
+    for (int s = lo; s < hi; ++s)
+      ScoreTile(b, t, staleTiles[s].first, staleTiles[s].second);
+  });
+}
 
-  float biomeScore = 1.0f - (tempDiff + moistureDiff) * 2.0f;
-  biomeScore = std::max(0.0f, biomeScore);
+// --- FLOW FIELDS ---
+// Per fauna species, the first step of a shortest 8-connected path over
+// habitable land (score > 0, not ocean) to the nearest prime habitat: cells
+// scoring at least FLOW_PRIME of the species' best. Built by a multi-source
+// BFS whenever the habitat goes stale (new climate solve or species table),
+// one species per pool task. Migration then reads one byte per cell instead
+// of scoring the neighbourhood.
+static const uint8_t FLOW_STAY = 8;    // Prime habitat: nowhere better to go
+static const uint8_t FLOW_NONE = 255;  // No prime habitat reachable
+static const float FLOW_PRIME = 0.9f;
+static const int FLOW_DX[8] = {-1, 0, 1, -1, 1, -1, 0, 1};
+static const int FLOW_DY[8] = {-1, -1, -1, 0, 0, 1, 1, 1};
+static std::vector<int> staleFlows; // Species indices
+
+static void BuildFlow(const WorldBuffers &b, const SpeciesTable &t, int k,
+                      uint32_t key) {
+  Habitat &h = habitats[k];
+  int side = habitatSide;
+  int tiles = habitatTilesX * habitatTilesX;
+  for (int tile = 0; tile < tiles; ++tile)
+    if (h.stamp[tile] != key) {
+      h.stamp[tile] = key;
+      ScoreTile(b, t, k, tile);
+    }
 
-  float foodScore = 0.0f;
-  if (dna.type == AgentType::FAUNA) {
-    for (auto const &pair : dna.diet) {
-      int resID = pair.first;
-      float required = pair.second;
-      float available = b.GetResource(cellIdx, resID);
-      if (available > 1.0f) // Some Threshold
-        foodScore += 1.0f;
+  const uint8_t *score = h.score.data();
+  uint8_t best = *std::max_element(h.score.begin(), h.score.end());
+  uint8_t prime = (uint8_t)std::max(1.0f, best * FLOW_PRIME);
+  h.flow.assign(b.count, FLOW_NONE);
+  uint8_t *flow = h.flow.data();
+  std::vector<int> queue;
+  for (uint32_t i = 0; i < b.count; ++i)
+    if (score[i] >= prime && b.height[i] >= 0.2f) {
+      flow[i] = FLOW_STAY;
+      queue.push_back((int)i);
+    }
+  // Each cell reached points back at the cell that reached it
+  for (size_t q = 0; q < queue.size(); ++q) {
+    int c = queue[q];
+    int x = c % side, y = c / side;
+    for (int d = 0; d < 8; ++d) {
+      int nx = x - FLOW_DX[d], ny = y - FLOW_DY[d];
+      if (nx < 0 || nx >= side || ny < 0 || ny >= side)
+        continue;
+      int n = ny * side + nx;
+      if (flow[n] != FLOW_NONE || score[n] == 0 || b.height[n] < 0.2f)
+        continue;
+      flow[n] = (uint8_t)d; // Step (FLOW_DX[d], FLOW_DY[d]) leads back to c
+      queue.push_back(n);
     }
   }
+  h.flowKey = key;
+}
+
+static void RefreshFlowFields(const WorldBuffers &b, const SpeciesTable &t,
+                              const std::vector<Buckets> &living) {
+  uint32_t key = ClimateSim::SolveCount() + 1;
+  staleFlows.clear();
+  for (int k = 0; k < t.Count(); ++k) {
+    if (!t.Is(k, SpeciesTable::FAUNA) || habitats[k].score.empty() ||
+        habitats[k].flowKey == key)
+      continue;
+    for (const Buckets &chunk : living)
+      if (!chunk.bySpecies[k].empty()) {
+        staleFlows.push_back(k);
+        break;
+      }
+  }
+  ThreadPool::ParallelFor(0, (int)staleFlows.size(), 1, [&](int lo, int hi) {
+    for (int s = lo; s < hi; ++s)
+      BuildFlow(b, t, staleFlows[s], key);
+  });
+}
+
+// --- HELPER: SCORING ---
+// Hot loops read the compiled SpeciesTable (AssetManager::Species) by species
+// index k; agentRegistry is only touched by the editors and spawners.
+// Cached habitat score plus the food and crowding terms, which change every
+// tick. The cell must lie in a tile RefreshHabitats covered this tick.
+float CalculateDesire(int cellIdx, const SpeciesTable &t, int k,
+                      const WorldBuffers &b) {
+  uint8_t habitat = habitats[k].score[cellIdx];
+  if (habitat == 0)
+    return 0.0f; // Too hot, cold, dry or wet
+  float biomeScore = (float)(habitat - 1) * (1.0f / 254.0f);
+
+  float foodScore = 0.0f;
+  if (t.Is(k, SpeciesTable::FAUNA)) {
+    uint32_t diet = t.dietMask[k];
+    for (int r = 0; diet >> r; ++r) // Stops past the last listed resource
+      if ((diet & (1u << r)) && b.GetResource(cellIdx, r) > 1.0f)
+        foodScore += 1.0f; // Some Threshold
+  }
 
   float crowding = 0.0f;
   float myPop = (float)b.population[cellIdx];
-  if (b.cultureID[cellIdx] == dna.id) {
+  if (b.cultureID[cellIdx] == t.ids[k]) {
     if (myPop > 5000.0f)
       crowding = 1.0f;
   }
@@ -78,42 +261,52 @@ float CalculateDesire(int cellIdx, const AgentDefinition &dna,
   return (biomeScore * 2.0f) + foodScore - crowding;
 }
 
-// Internal Logic Processor
-void ProcessAgentLogic(WorldBuffers &b, const NeighborGraph &g, int i,
-                       const AgentDefinition &dna, const ChronosConfig *c = nullptr) {
-  int myID = dna.id;
-  float myPop = (float)b.population[i];
-
-  // 1. METABOLISM
+// --- METABOLISM ---
+// Eats the diet from the cell's own stock and, if fed, produces the output and
+// grows. Touches only cell i, so it is safe to run in parallel.
+static bool Metabolize(WorldBuffers &b, int i, const SpeciesTable &t, int k,
+                       float &myPop, bool growRoll) {
+  const int R = SpeciesTable::R;
   bool isStarving = false;
-  for (auto const &pair : dna.diet) {
-    int resID = pair.first;
-    float amount = pair.second;
-    float needed = amount * (myPop / 100.0f);
-    float available = b.GetResource(i, resID);
+  const float *diet = t.Diet(k);
+  uint32_t dietMask = t.dietMask[k];
+  for (int r = 0; r < R; ++r) {
+    if (!(dietMask & (1u << r)))
+      continue;
+    float needed = diet[r] * (myPop / 100.0f);
+    float available = b.GetResource(i, r);
     if (available >= needed) {
-      b.AddResource(i, resID, -needed);
+      b.AddResource(i, r, -needed);
     } else {
       isStarving = true;
-      b.AddResource(i, resID, -available);
+      b.AddResource(i, r, -available);
     }
   }
 
   if (!isStarving) {
-    for (auto const &pair : dna.output) {
-      int resID = pair.first;
-      float amount = pair.second;
-      float production = amount * (myPop / 100.0f);
-      b.AddResource(i, resID, production);
-    }
+    const float *output = t.Output(k);
+    uint32_t outputMask = t.outputMask[k];
+    for (int r = 0; r < R; ++r)
+      if (outputMask & (1u << r))
+        b.AddResource(i, r, output[r] * (myPop / 100.0f));
 
     // Growth
-    if (myPop < 10000.0f && rand() % 100 < 10) {
-      myPop *= (1.0f + dna.expansionRate);
+    if (myPop < 10000.0f && growRoll) {
+      myPop *= (1.0f + t.expansionRate[k]);
     }
   } else {
     myPop *= 0.90f; // Starvation death
   }
+  return isStarving;
+}
+
+// Civilized cells: metabolism, then farming and taming of wild neighbours
+static void ProcessCivilized(WorldBuffers &b, const NeighborGraph &g, int i,
+                             const SpeciesTable &t, int k) {
+  int myID = t.ids[k];
+  FactionStats::Leave(b, i);
+  float myPop = (float)b.population[i];
+  Metabolize(b, i, t, k, myPop, rand() % 100 < 10);
 
   // Death from extreme causes
   if (myPop < 1.0f) {
@@ -122,122 +315,279 @@ void ProcessAgentLogic(WorldBuffers &b, const NeighborGraph &g, int i,
     return;
   }
 
-  // 2. MIGRATION & PREDATION (Animals)
-  if (dna.type == AgentType::FAUNA && myPop > 10.0f) {
-    // --- WILDLIFE ATTACKS ON CIVILIZATION ---
-    bool attacked = false;
-    float currentAggression = dna.aggression;
-    if (c) {
-      // Full moon (0.45 to 0.55) increases aggression significantly
-      if (c->moonPhase > 0.45f && c->moonPhase < 0.55f) {
-        currentAggression *= 1.5f;
+    // --- FARMING & TAMING (CIVILIZED) ---
+  if (b.civTier && b.civTier[i] >= 1) {
+    int offset = g.offsetTable[i];
+    int count = g.countTable[i];
+    for (int n = 0; n < count; ++n) {
+      int nIdx = g.neighborData[offset + n];
+      int nCulture = b.cultureID[nIdx];
+      if (nCulture != -1 && nCulture != myID) {
+        int nk = t.Index(nCulture);
+        if (nk == SpeciesTable::NONE)
+          continue;
+        uint8_t nf = t.flags[nk];
+        if ((nf & SpeciesTable::FLORA) && (nf & SpeciesTable::FARMABLE)) {
+          // Farm the flora, gaining resources (food: ID 0)
+          b.AddResource(i, 0, 5.0f);
+        } else if ((nf & SpeciesTable::FAUNA) &&
+                   (nf & SpeciesTable::DOMESTICATABLE)) {
+          // Tame the fauna, gaining resources and strength
+          b.AddResource(i, 0, 2.0f);
+          b.agentStrength[i] += 1.0f;
+        }
       }
     }
-    if (isStarving || currentAggression > 0.5f) { // Hungry or Predator
-      int offset = g.offsetTable[i];
-      int count = g.countTable[i];
-      for (int k = 0; k < count; ++k) {
-        int nIdx = g.neighborData[offset + k];
+  }
+
+  // Write back
+  b.population[i] = (uint32_t)myPop;
+  FactionStats::Enter(b, i);
+}
+
+// --- TWO-PHASE BIOLOGY ---
+// Phase 1 runs in parallel over fixed cell chunks: every wild cell first
+// metabolises (own cell only), then, once all cells are settled, reads its
+// neighbourhood and emits intents (attack, migrate, spread) into its chunk's
+// buffer without writing anything shared. Phase 2 sorts the intents by target
+// and hashed priority and applies them serially, re-checking each one against
+// the cell as earlier intents left it. Randomness comes from CellRandom, so a
+// tick's outcome does not depend on scan order or the thread count.
+enum IntentKind : uint8_t { ATTACK, MIGRATE, SPREAD };
+
+struct Intent {
+  int target;
+  int source;
+  uint32_t priority; // Hashed per source and tick; ties go to the lower source
+  int speciesID;
+  IntentKind kind;
+  float amount; // ATTACK: strength, MIGRATE: migrants
+};
+
+static std::vector<std::vector<Intent>> chunkIntents;
+static std::vector<Buckets> chunkLiving; // Wild cells, pruned by phase 1a
+static std::vector<Intent> intents;
+static std::vector<uint8_t> starving; // Phase 1 result per cell
+static uint32_t biologyTick = 0;
+static const int CELL_GRAIN = 8192;
+static const uint32_t GROWTH_STREAM = 0x47524f57u; // CellRandom streams
+static const uint32_t SPREAD_STREAM = 0x53505244u;
+static const uint32_t PRIORITY_STREAM = 0x50524931u;
+
+static Intent MakeIntent(int source, int speciesID) {
+  return Intent{-1, source,
+                HashMix(PRIORITY_STREAM + HashMix(biologyTick + HashMix(source))),
+                speciesID, ATTACK, 0.0f};
+}
+
+// Phase 1a for one species: metabolism, dropping the cells that die
+static void MetabolizeBucket(WorldBuffers &b, const SpeciesTable &t, int k,
+                             std::vector<int> &cells) {
+  size_t alive = 0;
+  for (int i : cells) {
+    float myPop = (float)b.population[i];
+    bool grow = CellRandom(i, biologyTick, GROWTH_STREAM) < 0.1f;
+    starving[i] = Metabolize(b, i, t, k, myPop, grow);
+
+    // Death from extreme causes
+    if (myPop < 1.0f) {
+      b.cultureID[i] = -1;
+      b.population[i] = 0;
+    } else {
+      b.population[i] = (uint32_t)myPop;
+      cells[alive++] = i;
+    }
+  }
+  cells.resize(alive);
+}
+
+// Utility weights, relative to one flow-field step
+static const float FOOD_PULL = 1.5f;  // Starving: towards stocked food
+static const float HUNT_PULL = 1.0f;  // Predators: towards prey
+static const float FEAR_PUSH = 1.5f;  // Prey: away from predators
+static const float CROWD_PUSH = 1.0f; // Over 5000: away from its own kind
+static const float STEER_MIN = 0.5f;  // Weaker urges leave the herd put
+
+// Neighbour in the octant of (vx, vy), or -1 (too weak or off the map)
+static int Steer(int i, int side, float vx, float vy) {
+  float len = std::max(std::abs(vx), std::abs(vy));
+  if (len < STEER_MIN)
+    return -1;
+  const float TAN_22_5 = 0.4142f;
+  int dx = vx > TAN_22_5 * len ? 1 : (vx < -TAN_22_5 * len ? -1 : 0);
+  int dy = vy > TAN_22_5 * len ? 1 : (vy < -TAN_22_5 * len ? -1 : 0);
+  int x = i % side + dx, y = i / side + dy;
+  if (x < 0 || x >= side || y < 0 || y >= side)
+    return -1;
+  return y * side + x;
+}
+
+// 2. MIGRATION & PREDATION (Animals)
+static void FaunaIntents(const WorldBuffers &b, const NeighborGraph &g,
+                         const SpeciesTable &t, int k, const ChronosConfig &c,
+                         const std::vector<int> &cells,
+                         std::vector<Intent> &out) {
+  int myID = t.ids[k];
+  float aggression = t.aggression[k];
+  float currentAggression = aggression;
+  // Full moon (0.45 to 0.55) increases aggression significantly
+  if (c.moonPhase > 0.45f && c.moonPhase < 0.55f)
+    currentAggression *= 1.5f;
+  bool predator = currentAggression > 0.5f;
+  const uint8_t *flow = habitats[k].flow.data();
+  const uint8_t *score = habitats[k].score.data();
+  int side = habitatSide;
+  // A crowded herd moves away from its own kind (as InfluenceMap files it)
+  InfluenceMap::Field ownKind =
+      aggression > 0.5f ? InfluenceMap::THREAT : InfluenceMap::PREY;
+
+  for (int i : cells) {
+    float myPop = (float)b.population[i];
+    if (myPop <= 10.0f)
+      continue;
+    int offset = g.offsetTable[i];
+    int count = g.countTable[i];
+    Intent in = MakeIntent(i, myID);
+
+    // --- WILDLIFE ATTACKS ON CIVILIZATION ---
+    bool attacked = false;
+    if ((starving[i] || predator) && // Hungry or Predator, near people
+        InfluenceMap::Sample(InfluenceMap::CIVILIZATION, i) > 0.0f) {
+      for (int n = 0; n < count; ++n) {
+        int nIdx = g.neighborData[offset + n];
         int nCulture = b.cultureID[nIdx];
         if (nCulture != -1 && nCulture != myID) {
-          const AgentDefinition& nDef = AssetManager::agentRegistry[nCulture];
-          if (nDef.type == AgentType::CIVILIZED) {
-            // Attack civilization
-            float attackStrength = myPop * dna.aggression * 0.1f;
-            float damage = attackStrength;
-
-            // Defenses
-            if (b.defense) damage -= b.defense[nIdx];
-            if (damage < 0) damage = 0;
-
-            if (b.population[nIdx] > damage) {
-                b.population[nIdx] -= (uint32_t)damage;
-            } else {
-                b.population[nIdx] = 0;
-                b.cultureID[nIdx] = -1; // Wipe them out
-            }
-
-            // Fauna feeds on them
-            myPop += attackStrength * 0.5f;
+          int nk = t.Index(nCulture);
+          if (nk != SpeciesTable::NONE && t.Is(nk, SpeciesTable::CIVILIZED)) {
+            in.target = nIdx;
+            in.amount = myPop * aggression * 0.1f;
+            out.push_back(in);
             attacked = true;
             break; // only attack one neighbor per tick
           }
         }
       }
     }
+    if (attacked)
+      continue;
 
-    if (!attacked) {
-      int bestN = -1;
-      float currentScore = CalculateDesire(i, dna, b);
-      float bestScore = currentScore;
-      int offset = g.offsetTable[i];
-      int count = g.countTable[i];
-
-      for (int k = 0; k < count; ++k) {
-        int nIdx = g.neighborData[offset + k];
-        if (b.height[nIdx] < 0.2f)
-          continue; // Ocean
-        if (b.cultureID[nIdx] != -1 && b.cultureID[nIdx] != myID)
-          continue;
-
-        float s = CalculateDesire(nIdx, dna, b);
-        if (s > bestScore) {
-          bestScore = s;
-          bestN = nIdx;
-        }
-      }
-
-      if (bestN != -1 && bestScore > currentScore * 1.05f) {
-        float migrants = myPop * 0.2f;
-        if (b.cultureID[bestN] == -1) {
-          b.cultureID[bestN] = myID;
-          b.population[bestN] = 0;
-        }
-        b.population[bestN] += (uint32_t)migrants;
-        myPop -= migrants;
-      }
+    // Utility steering: the habitat flow, plus the influence maps for
+    // hunger, hunting, fear and crowding
+    float vx = 0.0f, vy = 0.0f, gx, gy;
+    uint8_t step = flow[i];
+    if (step < FLOW_STAY) {
+      vx = (float)FLOW_DX[step];
+      vy = (float)FLOW_DY[step];
+    }
+    if (starving[i]) {
+      InfluenceMap::Gradient(InfluenceMap::FOOD, i, gx, gy);
+      vx += FOOD_PULL * gx;
+      vy += FOOD_PULL * gy;
+    }
+    if (predator) {
+      InfluenceMap::Gradient(InfluenceMap::PREY, i, gx, gy);
+      vx += HUNT_PULL * gx;
+      vy += HUNT_PULL * gy;
+    } else {
+      InfluenceMap::Gradient(InfluenceMap::THREAT, i, gx, gy);
+      vx -= FEAR_PUSH * gx;
+      vy -= FEAR_PUSH * gy;
+    }
+    if (myPop > 5000.0f) {
+      InfluenceMap::Gradient(ownKind, i, gx, gy);
+      vx -= CROWD_PUSH * gx;
+      vy -= CROWD_PUSH * gy;
     }
-  }
 
-  // 3. REPRODUCTION (Plants / Spreads)
-  if (dna.type == AgentType::FLORA && myPop > 500.0f) {
-    if (rand() % 100 < (dna.expansionRate * 50)) {
-      int offset = g.offsetTable[i];
-      int count = g.countTable[i];
-      int nIdx = g.neighborData[offset + (rand() % count)];
-
-      if (b.cultureID[nIdx] == -1 && CalculateDesire(nIdx, dna, b) > 0.4f) {
-        if (b.height[nIdx] > 0.2f) { // Land only
-          b.cultureID[nIdx] = myID;
-          b.population[nIdx] = 100;
-        }
-      }
+    int bestN = -1;
+    int n = Steer(i, side, vx, vy);
+    if (n != -1 && score[n] > 0 && b.height[n] >= 0.2f &&
+        (b.cultureID[n] == -1 || b.cultureID[n] == myID) &&
+        b.population[n] <= 5000)
+      bestN = n;
+
+    if (bestN != -1) {
+      in.target = bestN;
+      in.kind = MIGRATE;
+      in.amount = myPop * 0.2f;
+      out.push_back(in);
     }
   }
+}
 
-    // --- FARMING & TAMING (CIVILIZED) ---
-  if (dna.type == AgentType::CIVILIZED && b.civTier && b.civTier[i] >= 1) {
-    int offset = g.offsetTable[i];
+// 3. REPRODUCTION (Plants / Spreads)
+static void FloraIntents(const WorldBuffers &b, const NeighborGraph &g,
+                         const SpeciesTable &t, int k,
+                         const std::vector<int> &cells,
+                         std::vector<Intent> &out) {
+  int myID = t.ids[k];
+  float spreadChance = t.expansionRate[k] * 0.5f;
+  for (int i : cells) {
+    if (b.population[i] <= 500 ||
+        CellRandom(i, biologyTick, SPREAD_STREAM) >= spreadChance)
+      continue;
     int count = g.countTable[i];
-    for (int k = 0; k < count; ++k) {
-      int nIdx = g.neighborData[offset + k];
-      int nCulture = b.cultureID[nIdx];
-      if (nCulture != -1 && nCulture != myID) {
-        const AgentDefinition& nDef = AssetManager::agentRegistry[nCulture];
-        if (nDef.type == AgentType::FLORA && nDef.isFarmable) {
-          // Farm the flora, gaining resources (food: ID 0)
-          b.AddResource(i, 0, 5.0f);
-        } else if (nDef.type == AgentType::FAUNA && nDef.isDomesticatable) {
-          // Tame the fauna, gaining resources and strength
-          b.AddResource(i, 0, 2.0f);
-          b.agentStrength[i] += 1.0f;
-        }
-      }
+    float pick = CellRandom(i, biologyTick, SPREAD_STREAM + 1);
+    int nIdx =
+        g.neighborData[g.offsetTable[i] + std::min(count - 1, (int)(pick * count))];
+    if (b.cultureID[nIdx] == -1 && b.height[nIdx] > 0.2f && // Land only
+        CalculateDesire(nIdx, t, k, b) > 0.4f) {
+      Intent in = MakeIntent(i, myID);
+      in.target = nIdx;
+      in.kind = SPREAD;
+      out.push_back(in);
     }
   }
+}
 
-  // Write back
-  b.population[i] = (uint32_t)myPop;
+// Applies one intent if it still holds for the target as it is now
+static void ApplyIntent(WorldBuffers &b, const SpeciesTable &t,
+                        const Intent &in) {
+  int target = in.target, source = in.source;
+  int theirID = b.cultureID[target];
+  switch (in.kind) {
+  case ATTACK: {
+    int nk = t.Index(theirID);
+    if (nk == SpeciesTable::NONE || !t.Is(nk, SpeciesTable::CIVILIZED))
+      return; // Already wiped out by a stronger claim this tick
+    float damage = in.amount;
+
+    // Defenses
+    if (b.defense) damage -= b.defense[target];
+    if (damage < 0) damage = 0;
+
+    FactionStats::Leave(b, target);
+    if (b.population[target] > damage) {
+      b.population[target] -= (uint32_t)damage;
+    } else {
+      b.population[target] = 0;
+      b.cultureID[target] = -1; // Wipe them out
+    }
+    FactionStats::Enter(b, target);
+
+    // Fauna feeds on them
+    b.population[source] += (uint32_t)(in.amount * 0.5f);
+    break;
+  }
+  case MIGRATE: {
+    if (theirID != -1 && theirID != in.speciesID)
+      return; // Claimed by another species first
+    uint32_t migrants = std::min((uint32_t)in.amount, b.population[source]);
+    if (theirID == -1) {
+      b.cultureID[target] = in.speciesID;
+      b.population[target] = 0;
+    }
+    b.population[target] += migrants;
+    b.population[source] -= migrants;
+    break;
+  }
+  case SPREAD:
+    if (theirID != -1)
+      return;
+    b.cultureID[target] = in.speciesID;
+    b.population[target] = 100;
+    break;
+  }
 }
 
 // Separated Biology System (FAUNA / FLORA)
@@ -246,35 +596,77 @@ void UpdateBiology(WorldBuffers &b, const NeighborGraph &g,
   if (!b.cultureID || !b.population || !s.enableBiology)
     return;
 
-  for (uint32_t i = 0; i < b.count; ++i) {
-    int myID = b.cultureID[i];
-    if (myID == -1 || myID >= (int)AssetManager::agentRegistry.size())
-      continue;
-
-    const AgentDefinition &dna = AssetManager::agentRegistry[myID];
-    if (dna.type == AgentType::FLORA || dna.type == AgentType::FAUNA) {
-      ProcessAgentLogic(b, g, i, dna, &c);
+  const SpeciesTable &t = AssetManager::Species();
+  int cells = (int)b.count;
+  int chunks = (cells + CELL_GRAIN - 1) / CELL_GRAIN;
+  starving.resize(b.count);
+  chunkIntents.resize(chunks);
+  chunkLiving.resize(chunks);
+
+  // Phase 1a: bucket the wild cells, then metabolism, own cell only
+  ThreadPool::ParallelFor(0, cells, CELL_GRAIN, [&](int lo, int hi) {
+    Buckets &living = chunkLiving[lo / CELL_GRAIN];
+    FillBuckets(b, t, lo, hi, SpeciesTable::FLORA | SpeciesTable::FAUNA,
+                living);
+    for (int k = 0; k < t.Count(); ++k)
+      if (!living.bySpecies[k].empty())
+        MetabolizeBucket(b, t, k, living.bySpecies[k]);
+  });
+
+  RefreshHabitats(b, t, chunkLiving);
+  RefreshFlowFields(b, t, chunkLiving);
+  InfluenceMap::Update(b);
+
+  // Phase 1b: intents, read-only, one kernel per species
+  ThreadPool::ParallelFor(0, chunks, 1, [&](int lo, int hi) {
+    for (int chunk = lo; chunk < hi; ++chunk) {
+      std::vector<Intent> &out = chunkIntents[chunk];
+      out.clear();
+      const Buckets &living = chunkLiving[chunk];
+      for (int k = 0; k < t.Count(); ++k) {
+        const std::vector<int> &bucket = living.bySpecies[k];
+        if (bucket.empty())
+          continue;
+        if (t.Is(k, SpeciesTable::FAUNA))
+          FaunaIntents(b, g, t, k, c, bucket, out);
+        else
+          FloraIntents(b, g, t, k, bucket, out);
+      }
     }
-  }
+  });
+
+  // Phase 2: resolve per target, highest priority first
+  intents.clear();
+  for (const auto &chunk : chunkIntents)
+    intents.insert(intents.end(), chunk.begin(), chunk.end());
+  std::sort(intents.begin(), intents.end(),
+            [](const Intent &x, const Intent &y) {
+              if (x.target != y.target)
+                return x.target < y.target;
+              if (x.priority != y.priority)
+                return x.priority > y.priority;
+              return x.source < y.source;
+            });
+  for (const Intent &in : intents)
+    ApplyIntent(b, t, in);
+  biologyTick++;
 }
 
+static Buckets civCells;
+
 // Correct Signature Wrapper for Civilization logic
 void UpdateCivilization(WorldBuffers &b, const NeighborGraph &g) {
   if (!b.cultureID || !b.population)
     return;
 
-  for (uint32_t i = 0; i < b.count; ++i) {
-    int myID = b.cultureID[i];
-    if (myID == -1 || myID >= (int)AssetManager::agentRegistry.size())
-      continue;
-
-    const AgentDefinition &dna = AssetManager::agentRegistry[myID];
-    if (dna.type == AgentType::CIVILIZED) {
-      ProcessAgentLogic(b, g, i, dna, nullptr);
-      // CivilizationSim handles construction and age-related death elsewhere
-      // (CivilizationSim::Update)
-    }
-  }
+  // Serial (rand() and neighbour deaths), one civilized species at a time
+  const SpeciesTable &t = AssetManager::Species();
+  FillBuckets(b, t, 0, (int)b.count, SpeciesTable::CIVILIZED, civCells);
+  for (int k = 0; k < t.Count(); ++k)
+    for (int i : civCells.bySpecies[k])
+      ProcessCivilized(b, g, i, t, k);
+  // CivilizationSim handles construction and age-related death elsewhere
+  // (CivilizationSim::Update)
 }
 
 // --- UTILS ---
@@ -295,6 +687,7 @@ void SpawnCivilization(WorldBuffers &b, int count) {
       b.cultureID[idx] = civID;
       b.population[idx] = 1000;
       b.civTier[idx] = 1;
+      FactionStats::Enter(b, idx);
       LoreScribeNS::LogEvent(0, "SPAWN", idx, "A new civilization appears.");
     }
   }
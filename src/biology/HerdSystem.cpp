@@ -0,0 +1,389 @@
+#include "../../include/AssetManager.hpp"
+#include "../../include/Biology.hpp"
+#include "../../include/Lore.hpp"
+#include "../../include/ThreadPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace HerdSystem {
+// --- TUNING ---
+static const float SPEED = 1.0f;       // Cells per tick at full urge
+static const float FOOD_PULL = 1.0f;   // Grazers: towards stocked food
+static const float HUNT_PULL = 1.0f;   // Predators: towards prey
+static const float FEAR_PUSH = 1.5f;   // Grazers: away from predators
+static const float SPACING = 3.0f;     // Herds closer than this push apart
+static const float SPACING_PUSH = 1.0f;
+static const float WANDER = 0.3f;      // Random heading mixed into the urge
+static const int MAX_SCAN = 64;        // Spacing reads per hash row, at most
+static const float GROWTH = 0.1f;      // Times expansionRate, per tick
+static const float DECLINE = 0.05f;    // Hungry or out of its climate
+static const uint32_t HERD_MAX = 5000; // Same cap as a wild cell
+static const uint32_t HERD_MIN = 20;   // Smallest cell SpawnHerds splits
+static const float PREDATOR_AGGRESSION = 0.5f;
+static const int HASH_CELL = 4;        // Spatial hash bucket side, in cells
+static const int HERD_GRAIN = 4096;
+static const uint32_t WANDER_STREAM = 0x48455244u; // CellRandom streams
+static const uint32_t SPAWN_STREAM = 0x53504157u;
+
+static Components c;
+static std::vector<int> freeSlots;   // Reusable once their heads are unsynced
+static std::vector<int> pendingFree; // Despawned since the last sync
+static int liveCount = 0;
+static uint32_t herdTick = 0;
+static uint32_t spawnRound = 0; // SpawnHerds calls so far
+static bool hashDirty = true; // Herds spawned, died or moved since BuildHash
+
+// Next positions and head counts, written by the parallel steer
+static std::vector<float> nextX, nextY;
+static std::vector<uint32_t> nextCount;
+
+// --- POOL ---
+Handle Spawn(int speciesID, float x, float y, uint32_t headcount,
+             const std::string &name) {
+  int s;
+  if (!freeSlots.empty()) {
+    s = freeSlots.back();
+    freeSlots.pop_back();
+  } else {
+    s = (int)c.alive.size();
+    c.x.push_back(0.0f);
+    c.y.push_back(0.0f);
+    c.speciesID.push_back(-1);
+    c.headcount.push_back(0);
+    c.generation.push_back(0);
+    c.alive.push_back(0);
+    c.name.emplace_back();
+    c.syncedCell.push_back(-1);
+    c.syncedCount.push_back(0);
+  }
+  c.x[s] = x;
+  c.y[s] = y;
+  c.speciesID[s] = speciesID;
+  c.headcount[s] = headcount;
+  c.alive[s] = 1;
+  c.name[s] = name;
+  c.syncedCell[s] = -1;
+  c.syncedCount[s] = 0;
+  ++liveCount;
+  hashDirty = true;
+  return {s, c.generation[s]};
+}
+
+bool Alive(Handle h) {
+  return h.slot >= 0 && h.slot < (int)c.alive.size() && c.alive[h.slot] &&
+         c.generation[h.slot] == h.generation;
+}
+
+void Despawn(Handle h) {
+  if (!Alive(h))
+    return;
+  c.alive[h.slot] = 0;
+  c.generation[h.slot]++;
+  --liveCount;
+  pendingFree.push_back(h.slot);
+  hashDirty = true;
+}
+
+int Count() { return liveCount; }
+const Components &Get() { return c; }
+
+void Clear() {
+  c = Components();
+  freeSlots.clear();
+  pendingFree.clear();
+  liveCount = 0;
+  hashDirty = true;
+}
+
+// --- SPATIAL HASH ---
+// Live slots counting-sorted into HASH_CELL x HASH_CELL buckets, in slot order
+// within a bucket, with their positions copied alongside so a query scans
+// contiguous memory. Rebuilt lazily after herds spawn, die or move.
+static int side = 0, hashSide = 0;
+static std::vector<int> bucketStart; // hashSide^2 + 1 offsets into bucketSlots
+static std::vector<int> bucketSlots;
+static std::vector<float> bucketX, bucketY;
+static std::vector<int> slotBucket;
+
+static int BucketOf(float x, float y) {
+  int bx = std::min(std::max((int)x / HASH_CELL, 0), hashSide - 1);
+  int by = std::min(std::max((int)y / HASH_CELL, 0), hashSide - 1);
+  return by * hashSide + bx;
+}
+
+static void BuildHash() {
+  if (!hashDirty || hashSide == 0)
+    return;
+  int buckets = hashSide * hashSide;
+  int slots = (int)c.alive.size();
+  bucketStart.assign(buckets + 1, 0);
+  slotBucket.resize(slots);
+  for (int s = 0; s < slots; ++s) {
+    slotBucket[s] = c.alive[s] ? BucketOf(c.x[s], c.y[s]) : -1;
+    if (slotBucket[s] >= 0)
+      bucketStart[slotBucket[s] + 1]++;
+  }
+  for (int i = 0; i < buckets; ++i)
+    bucketStart[i + 1] += bucketStart[i];
+  bucketSlots.resize(bucketStart[buckets]);
+  bucketX.resize(bucketSlots.size());
+  bucketY.resize(bucketSlots.size());
+  std::vector<int> fill(bucketStart.begin(), bucketStart.end() - 1);
+  for (int s = 0; s < slots; ++s) {
+    if (slotBucket[s] < 0)
+      continue;
+    int j = fill[slotBucket[s]]++;
+    bucketSlots[j] = s;
+    bucketX[j] = c.x[s];
+    bucketY[j] = c.y[s];
+  }
+  hashDirty = false;
+}
+
+// Calls fn(slot, ox, oy) for live herds within 'radius' of (x, y) until it
+// returns false. Read-only, safe from the parallel steer.
+template <typename Fn>
+static void ForEachNear(float x, float y, float radius, Fn fn) {
+  if (hashSide == 0)
+    return;
+  int bx0 = std::max((int)((x - radius) / HASH_CELL), 0);
+  int by0 = std::max((int)((y - radius) / HASH_CELL), 0);
+  int bx1 = std::min((int)((x + radius) / HASH_CELL), hashSide - 1);
+  int by1 = std::min((int)((y + radius) / HASH_CELL), hashSide - 1);
+  float r2 = radius * radius;
+  for (int by = by0; by <= by1; ++by)
+    for (int bx = bx0; bx <= bx1; ++bx) {
+      int bucket = by * hashSide + bx;
+      for (int j = bucketStart[bucket]; j < bucketStart[bucket + 1]; ++j) {
+        float dx = bucketX[j] - x, dy = bucketY[j] - y;
+        if (dx * dx + dy * dy <= r2 && !fn(bucketSlots[j], bucketX[j], bucketY[j]))
+          return;
+      }
+    }
+}
+
+void Query(float x, float y, float radius, std::vector<int> &out) {
+  out.clear();
+  BuildHash();
+  ForEachNear(x, y, radius, [&](int o, float, float) {
+    out.push_back(o);
+    return true;
+  });
+}
+
+// --- STEER ---
+// Reads only the previous positions and the cell layers; every slot writes
+// its own next state. Herds are visited in hash order [lo, hi) so that
+// neighbouring buckets are still in cache from the herd before.
+static int CellAt(float x, float y) { return (int)y * side + (int)x; }
+
+// Push away from herds within SPACING, fading linearly with the squared
+// distance. The buckets of one hash row are consecutive, so each row is a
+// single branch-free run over at most MAX_SCAN herds (the herd itself sits
+// at distance 0 and adds nothing).
+static void Spacing(float x, float y, float &vx, float &vy) {
+  int bx0 = std::max((int)((x - SPACING) / HASH_CELL), 0);
+  int by0 = std::max((int)((y - SPACING) / HASH_CELL), 0);
+  int bx1 = std::min((int)((x + SPACING) / HASH_CELL), hashSide - 1);
+  int by1 = std::min((int)((y + SPACING) / HASH_CELL), hashSide - 1);
+  const float invR2 = 1.0f / (SPACING * SPACING);
+  for (int by = by0; by <= by1; ++by) {
+    int lo = bucketStart[by * hashSide + bx0];
+    int hi = std::min(bucketStart[by * hashSide + bx1 + 1], lo + MAX_SCAN);
+    float px = 0.0f, py = 0.0f;
+    for (int j = lo; j < hi; ++j) {
+      float dx = x - bucketX[j], dy = y - bucketY[j];
+      float d2 = dx * dx + dy * dy;
+      float push = SPACING_PUSH * std::max(1.0f - d2 * invR2, 0.0f);
+      px += dx * push;
+      py += dy * push;
+    }
+    vx += px;
+    vy += py;
+  }
+}
+
+static void Steer(const WorldBuffers &b, const SpeciesTable &t, int lo,
+                  int hi) {
+  for (int j = lo; j < hi; ++j) {
+    int s = bucketSlots[j];
+    float x = bucketX[j], y = bucketY[j];
+    nextX[s] = x;
+    nextY[s] = y;
+    int k = t.Index(c.speciesID[s]);
+    if (k == SpeciesTable::NONE) {
+      nextCount[s] = 0; // Species deleted in the editor
+      continue;
+    }
+    int cell = CellAt(x, y);
+    bool predator = t.aggression[k] > PREDATOR_AGGRESSION;
+
+    // Head count: grazers need food around, predators need prey
+    float temp = b.temperature[cell], moist = b.moisture[cell];
+    bool livable = temp >= t.tempLow[k] && temp <= t.tempHigh[k] &&
+                   moist >= t.moistureLow[k] && moist <= t.moistureHigh[k];
+    InfluenceMap::Field meal =
+        predator ? InfluenceMap::PREY : InfluenceMap::FOOD;
+    bool fed = InfluenceMap::Sample(meal, cell) > 0.0f;
+    uint32_t n = c.headcount[s];
+    if (livable && fed)
+      n = std::min(HERD_MAX,
+                   n + std::max(1u, (uint32_t)(n * t.expansionRate[k] *
+                                               GROWTH)));
+    else
+      n -= std::min(n, std::max(1u, (uint32_t)(n * DECLINE)));
+    nextCount[s] = n;
+
+    // Urge: meal gradient, fear, spacing from other herds and a little wander
+    float vx, vy, gx, gy;
+    InfluenceMap::Gradient(meal, cell, gx, gy);
+    float pull = predator ? HUNT_PULL : FOOD_PULL;
+    vx = pull * gx;
+    vy = pull * gy;
+    if (!predator) {
+      InfluenceMap::Gradient(InfluenceMap::THREAT, cell, gx, gy);
+      vx -= FEAR_PUSH * gx;
+      vy -= FEAR_PUSH * gy;
+    }
+    Spacing(x, y, vx, vy);
+    float angle = 6.2831853f * CellRandom((uint32_t)s, herdTick, WANDER_STREAM);
+    vx += WANDER * std::cos(angle);
+    vy += WANDER * std::sin(angle);
+
+    float len = std::sqrt(vx * vx + vy * vy);
+    if (len < 1e-6f)
+      continue;
+    float step = SPEED * std::min(len, 1.0f) / len;
+    float nx = std::min(std::max(x + vx * step, 0.0f), (float)side - 0.01f);
+    float ny = std::min(std::max(y + vy * step, 0.0f), (float)side - 0.01f);
+    if (b.height[CellAt(nx, ny)] < 0.2f)
+      continue; // Ocean
+    nextX[s] = nx;
+    nextY[s] = ny;
+  }
+}
+
+// --- SYNC ---
+// Heads a herd has written into its cell; a cell only ever holds one
+// species, so a herd can't enter cells another species holds
+static bool Claimable(const WorldBuffers &b, int cell, int speciesID) {
+  return b.cultureID[cell] == -1 || b.cultureID[cell] == speciesID;
+}
+
+static void Unsync(WorldBuffers &b, int s) {
+  int cell = c.syncedCell[s];
+  if (cell >= 0 && b.cultureID[cell] == c.speciesID[s]) {
+    b.population[cell] -= std::min(b.population[cell], c.syncedCount[s]);
+    if (b.population[cell] == 0)
+      b.cultureID[cell] = -1;
+  }
+  c.syncedCell[s] = -1;
+  c.syncedCount[s] = 0;
+}
+
+static void SyncTo(WorldBuffers &b, int s, int cell) {
+  b.cultureID[cell] = c.speciesID[s];
+  b.population[cell] += c.headcount[s];
+  c.syncedCell[s] = cell;
+  c.syncedCount[s] = c.headcount[s];
+}
+
+static void Sync(WorldBuffers &b) {
+  for (int s : pendingFree) {
+    Unsync(b, s);
+    freeSlots.push_back(s);
+  }
+  pendingFree.clear();
+
+  // Same order as the steer: every live herd, cell-coherent
+  for (int s : bucketSlots) {
+    c.headcount[s] = nextCount[s];
+    if (c.headcount[s] == 0) {
+      Despawn({s, c.generation[s]});
+      Unsync(b, s);
+      continue;
+    }
+    int from = CellAt(c.x[s], c.y[s]);
+    int to = CellAt(nextX[s], nextY[s]);
+    // Biology may have emptied or handed over the cell since the last sync
+    if (to == c.syncedCell[s] && c.headcount[s] == c.syncedCount[s] &&
+        b.cultureID[to] == c.speciesID[s]) {
+      c.x[s] = nextX[s];
+      c.y[s] = nextY[s];
+      continue;
+    }
+    int id = c.speciesID[s];
+    Unsync(b, s);
+    if (Claimable(b, to, id)) {
+      c.x[s] = nextX[s];
+      c.y[s] = nextY[s];
+      SyncTo(b, s, to);
+    } else if (Claimable(b, from, id)) {
+      SyncTo(b, s, from); // Blocked: stays put
+    } // else taken from under it: roams unsynced until a cell frees up
+  }
+  for (int s : pendingFree)
+    freeSlots.push_back(s); // Died above, already unsynced
+  pendingFree.clear();
+}
+
+void Update(WorldBuffers &b) {
+  if (c.alive.empty() || !b.cultureID || !b.population)
+    return;
+  int newSide = (int)std::sqrt(b.count);
+  if (newSide != side) {
+    side = newSide;
+    hashSide = (side + HASH_CELL - 1) / HASH_CELL;
+    hashDirty = true;
+  }
+  herdTick++;
+  BuildHash();
+
+  int slots = (int)c.alive.size();
+  nextX.resize(slots);
+  nextY.resize(slots);
+  nextCount.resize(slots);
+  const SpeciesTable &t = AssetManager::Species();
+  ThreadPool::ParallelFor(0, (int)bucketSlots.size(), HERD_GRAIN,
+                          [&](int lo, int hi) { Steer(b, t, lo, hi); });
+
+  Sync(b);
+  hashDirty = true;
+  BuildHash();
+}
+
+// --- SPAWNING ---
+void SpawnHerds(WorldBuffers &b, int count) {
+  if (AssetManager::agentRegistry.empty() || !b.cultureID || !b.population)
+    return;
+  const SpeciesTable &t = AssetManager::Species();
+  side = (int)std::sqrt(b.count);
+  hashSide = (side + HASH_CELL - 1) / HASH_CELL;
+
+  // Candidate cells come from CellRandom, one draw per attempt, so the same
+  // map and call order always split off the same herds
+  spawnRound++;
+  int spawned = 0;
+  for (int attempt = 0; attempt < count * 10 && spawned < count; ++attempt) {
+    float r = CellRandom((uint32_t)attempt, spawnRound, SPAWN_STREAM);
+    int idx = std::min((int)(r * b.count), (int)b.count - 1);
+    int k = t.Index(b.cultureID[idx]);
+    if (k == SpeciesTable::NONE || !t.Is(k, SpeciesTable::FAUNA) ||
+        b.population[idx] < HERD_MIN)
+      continue;
+    const auto &dna = AssetManager::agentRegistry[k];
+    std::string name = t.aggression[k] > PREDATOR_AGGRESSION
+                           ? NameGenerator::GeneratePersonName()
+                           : dna.name + " herd";
+    uint32_t heads = b.population[idx] / 2;
+    Handle h = Spawn(dna.id, (float)(idx % side) + 0.5f,
+                     (float)(idx / side) + 0.5f, heads, name);
+    // The heads are already in the cell: the herd owns them from now on
+    c.syncedCell[h.slot] = idx;
+    c.syncedCount[h.slot] = heads;
+    ++spawned;
+  }
+}
+
+} // namespace HerdSystem
@@ -0,0 +1,150 @@
+#include "../../include/AssetManager.hpp"
+#include "../../include/Biology.hpp"
+#include "../../include/ThreadPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace InfluenceMap {
+// --- TUNING ---
+static const float PREDATOR_AGGRESSION = 0.5f; // Fauna above this hunts
+static const float FLAT = 1e-3f; // Relative slope below which Gradient is 0
+static const int ROW_GRAIN = 16;
+static const int FOOD_STEP = 4; // Food read once per FOOD_STEP^2 cells
+
+static int side = 0, coarseSide = 0;
+static std::vector<float> fields[FIELD_COUNT]; // coarseSide^2 each
+static std::vector<float> scratch[FIELD_COUNT];
+
+// --- SEEDING ---
+// Mean per CELL x CELL block of each quantity (edge blocks average the cells
+// they have). Rows are walked in memory order into per-block sums. Food is
+// subsampled: each stock sits on a cache line of its own, and the blur
+// smooths the difference away.
+// Cells whose culture feeds no field are summed into a discard row instead
+// of being branched around; occupancy is too patchy to predict.
+static const int DISCARD = FIELD_COUNT;
+static std::vector<int8_t> fieldOfID; // (Agent ID + 1) -> field row
+
+static void Seed(const WorldBuffers &b, const SpeciesTable &t) {
+  int ids = (int)t.indexOfID.size();
+  fieldOfID.assign(ids + 1, DISCARD); // Slot 0 is cultureID -1
+  for (int id = 0; id < ids; ++id) {
+    int k = t.indexOfID[id];
+    if (k == SpeciesTable::NONE)
+      continue;
+    if (t.Is(k, SpeciesTable::CIVILIZED))
+      fieldOfID[id + 1] = CIVILIZATION;
+    else if (t.Is(k, SpeciesTable::FAUNA))
+      fieldOfID[id + 1] = t.aggression[k] > PREDATOR_AGGRESSION ? THREAT : PREY;
+  }
+  const int8_t *fieldOf = fieldOfID.data();
+  int cs = coarseSide;
+  const float *stock = b.resourceInventory; // Resource 0 of each cell
+  const int R = WorldBuffers::MAX_RESOURCES;
+  ThreadPool::ParallelFor(0, cs, ROW_GRAIN, [&](int rowLo, int rowHi) {
+    std::vector<float> sum((size_t)(DISCARD + 1) * cs);
+    for (int cy = rowLo; cy < rowHi; ++cy) {
+      std::fill(sum.begin(), sum.end(), 0.0f);
+      int y0 = cy * CELL, y1 = std::min(side, y0 + CELL);
+      for (int y = y0; y < y1; ++y) {
+        int row = y * side;
+        const int *culture = b.cultureID + row;
+        const uint32_t *pop = b.population + row;
+        float *food = sum.data() + FOOD * cs;
+        if (stock && (y - y0) % FOOD_STEP == 0)
+          for (int x = 0; x < side; x += FOOD_STEP)
+            food[x / CELL] += stock[(size_t)(row + x) * R];
+        for (int x = 0; x < side; ++x) {
+          unsigned slot = (unsigned)(culture[x] + 1);
+          slot = slot <= (unsigned)ids ? slot : 0;
+          sum[fieldOf[slot] * cs + x / CELL] += (float)pop[x];
+        }
+      }
+      int foodRows = (y1 - y0 + FOOD_STEP - 1) / FOOD_STEP;
+      for (int cx = 0; cx < cs; ++cx) {
+        int x0 = cx * CELL, x1 = std::min(side, x0 + CELL);
+        float inv = 1.0f / (float)((x1 - x0) * (y1 - y0));
+        for (int f = 0; f < FOOD; ++f)
+          fields[f][cy * cs + cx] = sum[f * cs + cx] * inv;
+        int foodCols = (x1 - x0 + FOOD_STEP - 1) / FOOD_STEP;
+        fields[FOOD][cy * cs + cx] =
+            sum[FOOD * cs + cx] / (float)(foodRows * foodCols);
+      }
+    }
+  });
+}
+
+// --- BLUR ---
+// Separable box blur of radius RADIUS, clamped at the map edge
+static void Blur(std::vector<float> &field, std::vector<float> &tmp) {
+  int cs = coarseSide;
+  ThreadPool::ParallelFor(0, cs, ROW_GRAIN, [&](int rowLo, int rowHi) {
+    for (int y = rowLo; y < rowHi; ++y) {
+      const float *row = field.data() + y * cs;
+      for (int x = 0; x < cs; ++x) {
+        int lo = std::max(0, x - RADIUS), hi = std::min(cs - 1, x + RADIUS);
+        float sum = 0.0f;
+        for (int n = lo; n <= hi; ++n)
+          sum += row[n];
+        tmp[y * cs + x] = sum / (float)(hi - lo + 1);
+      }
+    }
+  });
+  ThreadPool::ParallelFor(0, cs, ROW_GRAIN, [&](int rowLo, int rowHi) {
+    for (int y = rowLo; y < rowHi; ++y) {
+      int lo = std::max(0, y - RADIUS), hi = std::min(cs - 1, y + RADIUS);
+      float inv = 1.0f / (float)(hi - lo + 1);
+      for (int x = 0; x < cs; ++x) {
+        float sum = 0.0f;
+        for (int n = lo; n <= hi; ++n)
+          sum += tmp[n * cs + x];
+        field[y * cs + x] = sum * inv;
+      }
+    }
+  });
+}
+
+void Update(const WorldBuffers &b) {
+  if (!b.cultureID || !b.population)
+    return;
+  side = (int)std::sqrt(b.count);
+  coarseSide = (side + CELL - 1) / CELL;
+  size_t n = (size_t)coarseSide * coarseSide;
+  for (int f = 0; f < FIELD_COUNT; ++f) {
+    fields[f].resize(n);
+    scratch[f].resize(n);
+  }
+  Seed(b, AssetManager::Species());
+  for (int f = 0; f < FIELD_COUNT; ++f)
+    Blur(fields[f], scratch[f]);
+}
+
+// --- QUERIES ---
+static float At(Field f, int cx, int cy) {
+  cx = std::min(std::max(cx, 0), coarseSide - 1);
+  cy = std::min(std::max(cy, 0), coarseSide - 1);
+  return fields[f][cy * coarseSide + cx];
+}
+
+float Sample(Field f, int cell) {
+  if (fields[f].empty())
+    return 0.0f;
+  return At(f, (cell % side) / CELL, (cell / side) / CELL);
+}
+
+void Gradient(Field f, int cell, float &gx, float &gy) {
+  gx = gy = 0.0f;
+  if (fields[f].empty())
+    return;
+  int cx = (cell % side) / CELL, cy = (cell / side) / CELL;
+  float dx = At(f, cx + 1, cy) - At(f, cx - 1, cy);
+  float dy = At(f, cx, cy + 1) - At(f, cx, cy - 1);
+  float len = std::sqrt(dx * dx + dy * dy);
+  if (len <= FLAT * (At(f, cx, cy) + 1.0f))
+    return;
+  gx = dx / len;
+  gy = dy / len;
+}
+
+} // namespace InfluenceMap
@@ -0,0 +1,251 @@
+#include "../../include/DiffusionSolver.hpp"
+#include "../../include/ThreadPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace DiffusionSolver {
+template <typename T> T clamp_val(T val, T min, T max) {
+  if (val < min)
+    return min;
+  if (val > max)
+    return max;
+  return val;
+}
+
+// --- TUNING ---
+static const int PRE_SMOOTH = 2;
+static const int POST_SMOOTH = 2;
+static const int COARSE_SWEEPS = 30; // Jacobi sweeps on the coarsest level
+static const int MIN_SIDE = 4;       // Coarsest level is at most this wide
+static const float JACOBI_WEIGHT = 0.8f;
+static const int ROW_GRAIN = 16;
+
+// Level l solves (1 + a + d) u - a * mean8(u) = f with a = rate * ticks / 4^l
+// and d = decay * ticks: the neighbour mean approximates 3/8 h^2 times the
+// Laplacian and h doubles per level, while decay does not depend on h.
+// Coarse levels carry the error equation (u starts at zero).
+struct Level {
+  int side = 0;
+  float a = 0.0f, d = 0.0f;
+  std::vector<float> u, f, r, scratch;
+  std::vector<uint8_t> fixed; // Level 0 only: the residual there is zero, so
+                              // coarse levels need no mask of their own
+};
+
+static std::vector<Level> levels;
+static std::vector<float> chunkMax;
+
+// --- STENCIL ---
+// Mean of each cell's neighbours on row y (edge cells use the ones they have)
+static void NeighbourMean(const float *u, int side, int y, float *out) {
+  const float *mid = u + y * side;
+  bool up = y > 0, down = y < side - 1;
+  auto slow = [&](int x) {
+    float sum = 0.0f;
+    int count = 0;
+    for (int dy = -1; dy <= 1; ++dy) {
+      if ((dy < 0 && !up) || (dy > 0 && !down))
+        continue;
+      const float *row = mid + dy * side;
+      for (int dx = -1; dx <= 1; ++dx) {
+        int nx = x + dx;
+        if ((dx || dy) && nx >= 0 && nx < side) {
+          sum += row[nx];
+          ++count;
+        }
+      }
+    }
+    out[x] = count ? sum / count : mid[x];
+  };
+  if (!up || !down || side < 3) {
+    for (int x = 0; x < side; ++x)
+      slow(x);
+    return;
+  }
+  slow(0);
+  slow(side - 1);
+  const float *__restrict pu = mid - side;
+  const float *__restrict pm = mid;
+  const float *__restrict pd = mid + side;
+  float *__restrict po = out;
+  for (int x = 1; x < side - 1; ++x)
+    po[x] = (pu[x - 1] + pu[x] + pu[x + 1] + pm[x - 1] + pm[x + 1] +
+             pd[x - 1] + pd[x] + pd[x + 1]) *
+            0.125f;
+}
+
+// Weighted Jacobi sweeps, parallel over row bands into 'scratch'
+static void Smooth(Level &L, int sweeps) {
+  int side = L.side;
+  float a = L.a, inv = 1.0f / (1.0f + a + L.d);
+  const uint8_t *fixed = L.fixed.empty() ? nullptr : L.fixed.data();
+  for (int s = 0; s < sweeps; ++s) {
+    const float *u = L.u.data();
+    const float *f = L.f.data();
+    float *next = L.scratch.data();
+    ThreadPool::ParallelFor(0, side, ROW_GRAIN, [&](int rowLo, int rowHi) {
+      std::vector<float> mean(side);
+      for (int y = rowLo; y < rowHi; ++y) {
+        NeighbourMean(u, side, y, mean.data());
+        int row = y * side;
+        for (int x = 0; x < side; ++x) {
+          int i = row + x;
+          float jacobi = (f[i] + a * mean[x]) * inv;
+          next[i] = u[i] + JACOBI_WEIGHT * (jacobi - u[i]);
+          if (fixed && fixed[i])
+            next[i] = u[i];
+        }
+      }
+    });
+    std::swap(L.u, L.scratch);
+  }
+}
+
+// r = f - A u; returns max |r|
+static float Residual(Level &L) {
+  int side = L.side;
+  float a = L.a, diag = 1.0f + a + L.d;
+  const uint8_t *fixed = L.fixed.empty() ? nullptr : L.fixed.data();
+  const float *u = L.u.data();
+  const float *f = L.f.data();
+  float *r = L.r.data();
+  int chunks = (side + ROW_GRAIN - 1) / ROW_GRAIN;
+  chunkMax.assign(chunks, 0.0f);
+  ThreadPool::ParallelFor(0, side, ROW_GRAIN, [&](int rowLo, int rowHi) {
+    std::vector<float> mean(side);
+    float worst = 0.0f;
+    for (int y = rowLo; y < rowHi; ++y) {
+      NeighbourMean(u, side, y, mean.data());
+      int row = y * side;
+      for (int x = 0; x < side; ++x) {
+        int i = row + x;
+        r[i] = (fixed && fixed[i]) ? 0.0f
+                                   : f[i] - (diag * u[i] - a * mean[x]);
+        worst = std::max(worst, std::fabs(r[i]));
+      }
+    }
+    chunkMax[rowLo / ROW_GRAIN] = worst;
+  });
+  return *std::max_element(chunkMax.begin(), chunkMax.end());
+}
+
+// --- GRID TRANSFER ---
+// Coarse right-hand side = mean of the 2x2 fine residuals (clamped at odd
+// edges, as in LayerPyramid)
+static void Restrict(const Level &fine, Level &coarse) {
+  int fs = fine.side, cs = coarse.side;
+  ThreadPool::ParallelFor(0, cs, ROW_GRAIN, [&](int rowLo, int rowHi) {
+    for (int y = rowLo; y < rowHi; ++y) {
+      int y0 = 2 * y, y1 = std::min(y0 + 1, fs - 1);
+      for (int x = 0; x < cs; ++x) {
+        int x0 = 2 * x, x1 = std::min(x0 + 1, fs - 1);
+        coarse.f[y * cs + x] =
+            (fine.r[y0 * fs + x0] + fine.r[y0 * fs + x1] +
+             fine.r[y1 * fs + x0] + fine.r[y1 * fs + x1]) *
+            0.25f;
+        coarse.u[y * cs + x] = 0.0f;
+      }
+    }
+  });
+}
+
+// Adds the bilinear (cell-centred) interpolation of the coarse correction
+static void ProlongAdd(const Level &coarse, Level &fine) {
+  int fs = fine.side, cs = coarse.side;
+  const uint8_t *fixed = fine.fixed.empty() ? nullptr : fine.fixed.data();
+  ThreadPool::ParallelFor(0, fs, ROW_GRAIN, [&](int rowLo, int rowHi) {
+    for (int y = rowLo; y < rowHi; ++y) {
+      float cy = clamp_val((y - 0.5f) * 0.5f, 0.0f, (float)(cs - 1));
+      int y0 = (int)cy, y1 = std::min(y0 + 1, cs - 1);
+      float wy = cy - (float)y0;
+      const float *r0 = coarse.u.data() + y0 * cs;
+      const float *r1 = coarse.u.data() + y1 * cs;
+      for (int x = 0; x < fs; ++x) {
+        int i = y * fs + x;
+        if (fixed && fixed[i])
+          continue;
+        float cx = clamp_val((x - 0.5f) * 0.5f, 0.0f, (float)(cs - 1));
+        int x0 = (int)cx, x1 = std::min(x0 + 1, cs - 1);
+        float wx = cx - (float)x0;
+        float top = r0[x0] + (r0[x1] - r0[x0]) * wx;
+        float bottom = r1[x0] + (r1[x1] - r1[x0]) * wx;
+        fine.u[i] += top + (bottom - top) * wy;
+      }
+    }
+  });
+}
+
+// --- SOLVER ---
+static void VCycle(size_t l) {
+  Level &L = levels[l];
+  if (l + 1 == levels.size()) {
+    Smooth(L, COARSE_SWEEPS);
+    return;
+  }
+  Smooth(L, PRE_SMOOTH);
+  Residual(L);
+  Restrict(L, levels[l + 1]);
+  VCycle(l + 1);
+  ProlongAdd(levels[l + 1], L);
+  Smooth(L, POST_SMOOTH);
+}
+
+// (Re)builds the level chain for this grid, step and fixed mask
+static void Prepare(int side, const Params &p, const uint8_t *fixed) {
+  int count = 0;
+  for (int s = side;; s = (s + 1) / 2) {
+    ++count;
+    if (s <= MIN_SIDE)
+      break;
+  }
+  levels.resize(count);
+  int s = side;
+  float a = p.rate * p.ticks;
+  for (int l = 0; l < count; ++l) {
+    Level &L = levels[l];
+    L.side = s;
+    L.a = a;
+    L.d = p.decay * p.ticks;
+    size_t n = (size_t)s * s;
+    L.u.resize(n);
+    L.f.resize(n);
+    L.r.resize(n);
+    L.scratch.resize(n);
+    if (fixed && l == 0)
+      L.fixed.assign(fixed, fixed + n);
+    else
+      L.fixed.clear();
+    s = (s + 1) / 2;
+    a *= 0.25f;
+  }
+}
+
+int Solve(float *field, int side, const Params &p, const uint8_t *fixed) {
+  if (!field || side <= 0 || p.ticks <= 0.0f || p.rate < 0.0f ||
+      p.decay < 0.0f)
+    return 0;
+  Prepare(side, p, fixed);
+  Level &top = levels[0];
+  size_t n = (size_t)side * side;
+  std::copy(field, field + n, top.f.begin()); // Backward Euler: A c' = c
+  std::copy(field, field + n, top.u.begin());
+
+  float scale = 0.0f;
+  for (size_t i = 0; i < n; ++i)
+    scale = std::max(scale, std::fabs(field[i]));
+  float target = p.tolerance * std::max(scale, 1e-12f);
+
+  int cycles = 0;
+  while (cycles < p.maxCycles) {
+    VCycle(0);
+    ++cycles;
+    if (Residual(top) <= target)
+      break;
+  }
+  std::copy(top.u.begin(), top.u.end(), field);
+  return cycles;
+}
+
+} // namespace DiffusionSolver
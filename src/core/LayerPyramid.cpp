@@ -0,0 +1,360 @@
+#include "../../include/LayerPyramid.hpp"
+#include "../../include/ThreadPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <vector>
+
+namespace LayerPyramid {
+
+static const int FLOAT_LAYERS = LAYER_FACTION; // Layers stored as float
+
+struct Level {
+  int side = 0;
+  int tilesX = 0;
+  std::vector<float> data[FLOAT_LAYERS]; // Empty on level 0
+  std::vector<int> faction;              // Empty on level 0
+  std::vector<uint8_t> dirty[LAYER_COUNT];
+};
+
+// --- PYRAMID STATE ---
+static std::vector<Level> levels;
+static const WorldBuffers *source = nullptr;
+static uint32_t sourceCount = 0;
+
+// --- 2x2 REDUCTIONS ---
+// Children are clamped at the far edge so odd sides fold into the last cell
+template <typename T>
+static void ReduceMean(const T *src, int srcSide, float *dst, int dstSide,
+                       int x0, int y0, int x1, int y1) {
+  for (int y = y0; y < y1; ++y) {
+    int sy0 = y * 2;
+    int sy1 = std::min(sy0 + 1, srcSide - 1);
+    const T *r0 = src + sy0 * srcSide;
+    const T *r1 = src + sy1 * srcSide;
+    float *out = dst + y * dstSide;
+    for (int x = x0; x < x1; ++x) {
+      int sx0 = x * 2;
+      int sx1 = std::min(sx0 + 1, srcSide - 1);
+      out[x] = ((float)r0[sx0] + (float)r0[sx1] + (float)r1[sx0] +
+                (float)r1[sx1]) *
+               0.25f;
+    }
+  }
+}
+
+static void ReduceMode(const int *src, int srcSide, int *dst, int dstSide,
+                       int x0, int y0, int x1, int y1) {
+  for (int y = y0; y < y1; ++y) {
+    int sy0 = y * 2;
+    int sy1 = std::min(sy0 + 1, srcSide - 1);
+    for (int x = x0; x < x1; ++x) {
+      int sx0 = x * 2;
+      int sx1 = std::min(sx0 + 1, srcSide - 1);
+      int a = src[sy0 * srcSide + sx0];
+      int b = src[sy0 * srcSide + sx1];
+      int c = src[sy1 * srcSide + sx0];
+      int d = src[sy1 * srcSide + sx1];
+
+      // Ties go to the earlier child (row-major), so results are stable
+      int best = a;
+      int bestN = 1 + (b == a) + (c == a) + (d == a);
+      int nb = 1 + (c == b) + (d == b);
+      if (nb > bestN) {
+        best = b;
+        bestN = nb;
+      }
+      int nc = 1 + (d == c);
+      if (nc > bestN)
+        best = c;
+      dst[y * dstSide + x] = best;
+    }
+  }
+}
+
+// Rebuilds one tile of 'layer' on level l (>= 1) from level l-1
+static void RebuildTile(int layer, int l, int tile) {
+  Level &lo = levels[l - 1];
+  Level &hi = levels[l];
+  int tx = tile % hi.tilesX;
+  int ty = tile / hi.tilesX;
+  int x0 = tx * TILE_SIZE;
+  int y0 = ty * TILE_SIZE;
+  int x1 = std::min(x0 + TILE_SIZE, hi.side);
+  int y1 = std::min(y0 + TILE_SIZE, hi.side);
+
+  if (layer == LAYER_FACTION) {
+    const int *src = (l == 1) ? source->factionID : lo.faction.data();
+    ReduceMode(src, lo.side, hi.faction.data(), hi.side, x0, y0, x1, y1);
+    return;
+  }
+
+  float *dst = hi.data[layer].data();
+  if (l > 1) {
+    ReduceMean(lo.data[layer].data(), lo.side, dst, hi.side, x0, y0, x1, y1);
+    return;
+  }
+  switch (layer) {
+  case LAYER_HEIGHT:
+    ReduceMean(source->height, lo.side, dst, hi.side, x0, y0, x1, y1);
+    break;
+  case LAYER_TEMPERATURE:
+    ReduceMean(source->temperature, lo.side, dst, hi.side, x0, y0, x1, y1);
+    break;
+  case LAYER_MOISTURE:
+    ReduceMean(source->moisture, lo.side, dst, hi.side, x0, y0, x1, y1);
+    break;
+  case LAYER_POPULATION:
+    ReduceMean(source->population, lo.side, dst, hi.side, x0, y0, x1, y1);
+    break;
+  }
+}
+
+// --- MAINTENANCE ---
+void Build(const WorldBuffers &b) {
+  levels.clear();
+  source = &b;
+  sourceCount = b.count;
+
+  int side = (int)std::sqrt(b.count);
+  if (side <= 0)
+    return;
+
+  // Level 0 only carries dirty flags; its data lives in the buffers
+  for (;;) {
+    Level lvl;
+    lvl.side = side;
+    lvl.tilesX = (side + TILE_SIZE - 1) / TILE_SIZE;
+    for (int k = 0; k < LAYER_COUNT; ++k)
+      lvl.dirty[k].assign(lvl.tilesX * lvl.tilesX, 0);
+    if (!levels.empty()) {
+      for (int k = 0; k < FLOAT_LAYERS; ++k)
+        lvl.data[k].assign(side * side, 0.0f);
+      lvl.faction.assign(side * side, 0);
+    }
+    levels.push_back(std::move(lvl));
+    if (side <= MIN_SIDE)
+      break;
+    side = (side + 1) / 2;
+  }
+
+  std::cout << "[PYRAMID] Built " << levels.size() << " levels ("
+            << levels[0].side << " -> " << levels.back().side << ")\n";
+
+  MarkAllDirty();
+  Update(b);
+}
+
+void MarkDirty(Layer layer, int x0, int y0, int x1, int y1) {
+  if (levels.empty())
+    return;
+  Level &base = levels[0];
+  x0 = std::max(x0, 0);
+  y0 = std::max(y0, 0);
+  x1 = std::min(x1, base.side);
+  y1 = std::min(y1, base.side);
+  if (x0 >= x1 || y0 >= y1)
+    return;
+
+  for (int ty = y0 / TILE_SIZE; ty <= (y1 - 1) / TILE_SIZE; ++ty)
+    for (int tx = x0 / TILE_SIZE; tx <= (x1 - 1) / TILE_SIZE; ++tx)
+      base.dirty[layer][ty * base.tilesX + tx] = 1;
+}
+
+void MarkLayerDirty(Layer layer) {
+  if (levels.empty())
+    return;
+  std::fill(levels[0].dirty[layer].begin(), levels[0].dirty[layer].end(), 1);
+}
+
+void MarkAllDirty() {
+  for (int k = 0; k < LAYER_COUNT; ++k)
+    MarkLayerDirty((Layer)k);
+}
+
+void Update(const WorldBuffers &b) {
+  if (levels.empty() || &b != source || b.count != sourceCount) {
+    Build(b);
+    return;
+  }
+
+  std::vector<int> work; // layer * tileCount + tile
+  for (int l = 1; l < (int)levels.size(); ++l) {
+    Level &lo = levels[l - 1];
+    Level &hi = levels[l];
+    int tileCount = hi.tilesX * hi.tilesX;
+
+    // A level-l tile covers 2x2 tiles of level l-1
+    work.clear();
+    for (int k = 0; k < LAYER_COUNT; ++k) {
+      std::vector<uint8_t> &lower = lo.dirty[k];
+      std::vector<uint8_t> &upper = hi.dirty[k];
+      for (int t = 0; t < (int)lower.size(); ++t) {
+        if (!lower[t])
+          continue;
+        lower[t] = 0;
+        int tx = (t % lo.tilesX) >> 1;
+        int ty = (t / lo.tilesX) >> 1;
+        upper[ty * hi.tilesX + tx] = 1;
+      }
+      for (int t = 0; t < tileCount; ++t)
+        if (upper[t])
+          work.push_back(k * tileCount + t);
+    }
+
+    ThreadPool::ParallelFor(0, (int)work.size(), 4, [&](int lo0, int hi0) {
+      for (int w = lo0; w < hi0; ++w)
+        RebuildTile(work[w] / tileCount, l, work[w] % tileCount);
+    });
+  }
+
+  for (int k = 0; k < LAYER_COUNT; ++k)
+    std::fill(levels.back().dirty[k].begin(), levels.back().dirty[k].end(), 0);
+}
+
+// --- QUERIES ---
+int Levels() { return (int)levels.size(); }
+
+int Side(int level) {
+  if (level < 0 || level >= (int)levels.size())
+    return 0;
+  return levels[level].side;
+}
+
+int LevelForScale(float cellsPerSample) {
+  if (levels.empty() || cellsPerSample <= 1.0f)
+    return 0;
+  int l = (int)std::floor(std::log2(cellsPerSample));
+  return std::min(l, (int)levels.size() - 1);
+}
+
+float Sample(Layer layer, int level, int x, int y) {
+  if (level < 0 || level >= (int)levels.size())
+    return 0.0f;
+  int side = levels[level].side;
+  x = std::clamp(x, 0, side - 1);
+  y = std::clamp(y, 0, side - 1);
+  int i = y * side + x;
+
+  if (layer == LAYER_FACTION)
+    return (float)SampleFaction(level, x, y);
+  if (level > 0)
+    return levels[level].data[layer][i];
+
+  switch (layer) {
+  case LAYER_HEIGHT:
+    return source->height[i];
+  case LAYER_TEMPERATURE:
+    return source->temperature[i];
+  case LAYER_MOISTURE:
+    return source->moisture[i];
+  case LAYER_POPULATION:
+    return (float)source->population[i];
+  default:
+    return 0.0f;
+  }
+}
+
+int SampleFaction(int level, int x, int y) {
+  if (level < 0 || level >= (int)levels.size())
+    return 0;
+  int side = levels[level].side;
+  x = std::clamp(x, 0, side - 1);
+  y = std::clamp(y, 0, side - 1);
+  if (level == 0)
+    return source->factionID[y * side + x];
+  return levels[level].faction[y * side + x];
+}
+
+float SampleUV(Layer layer, int level, float u, float v) {
+  int side = Side(level);
+  if (side == 0)
+    return 0.0f;
+  if (layer == LAYER_FACTION)
+    return (float)SampleFaction(level, (int)(u * side), (int)(v * side));
+
+  // Texel centres sit at (i + 0.5) / side
+  float fx = u * side - 0.5f;
+  float fy = v * side - 0.5f;
+  int x = (int)std::floor(fx);
+  int y = (int)std::floor(fy);
+  float tx = fx - x;
+  float ty = fy - y;
+  float top = Sample(layer, level, x, y) * (1.0f - tx) +
+              Sample(layer, level, x + 1, y) * tx;
+  float bot = Sample(layer, level, x, y + 1) * (1.0f - tx) +
+              Sample(layer, level, x + 1, y + 1) * tx;
+  return top * (1.0f - ty) + bot * ty;
+}
+
+// Coarsest level that still spans a few cells on the short axis
+static int RegionLevel(int w, int h) {
+  int extent = std::min(w, h);
+  int l = 0;
+  while (l + 1 < (int)levels.size() && (extent >> (l + 1)) >= 4)
+    ++l;
+  return l;
+}
+
+// Clips a full-res region to the grid; false if nothing is left
+static bool ClipRegion(int &x0, int &y0, int &x1, int &y1) {
+  if (levels.empty())
+    return false;
+  int side = levels[0].side;
+  x0 = std::max(x0, 0);
+  y0 = std::max(y0, 0);
+  x1 = std::min(x1, side);
+  y1 = std::min(y1, side);
+  return x0 < x1 && y0 < y1;
+}
+
+float RegionMean(Layer layer, int x0, int y0, int x1, int y1) {
+  if (!ClipRegion(x0, y0, x1, y1))
+    return 0.0f;
+  int l = RegionLevel(x1 - x0, y1 - y0);
+
+  // Coarse cells straddling the border are weighted by their overlap
+  double sum = 0.0;
+  for (int y = y0 >> l; y <= (y1 - 1) >> l; ++y) {
+    int wy = std::min(y1, (y + 1) << l) - std::max(y0, y << l);
+    for (int x = x0 >> l; x <= (x1 - 1) >> l; ++x) {
+      int wx = std::min(x1, (x + 1) << l) - std::max(x0, x << l);
+      sum += (double)Sample(layer, l, x, y) * wx * wy;
+    }
+  }
+  return (float)(sum / ((double)(x1 - x0) * (y1 - y0)));
+}
+
+int RegionFaction(int x0, int y0, int x1, int y1) {
+  if (!ClipRegion(x0, y0, x1, y1))
+    return 0;
+  int l = RegionLevel(x1 - x0, y1 - y0);
+  std::map<int, int> votes;
+  for (int y = y0 >> l; y <= (y1 - 1) >> l; ++y)
+    for (int x = x0 >> l; x <= (x1 - 1) >> l; ++x)
+      votes[SampleFaction(l, x, y)]++;
+
+  int best = 0, bestN = 0;
+  for (auto &v : votes) {
+    if (v.second > bestN) {
+      best = v.first;
+      bestN = v.second;
+    }
+  }
+  return best;
+}
+
+const float *Data(Layer layer, int level) {
+  if (layer == LAYER_FACTION || level < 1 || level >= (int)levels.size())
+    return nullptr;
+  return levels[level].data[layer].data();
+}
+
+const int *FactionData(int level) {
+  if (level < 1 || level >= (int)levels.size())
+    return nullptr;
+  return levels[level].faction.data();
+}
+
+} // namespace LayerPyramid
@@ -1,8 +1,15 @@
+#include "../../include/Environment.hpp"
 #include "../../include/FastNoiseLite.h"
+#include "../../include/LayerPyramid.hpp"
 #include "../../include/Terrain.hpp"
+#include "../../include/ThreadPool.hpp"
 #include "../../include/stb_image.h"
+#include <atomic>
+#include <climits>
 #include <cmath>
 #include <iostream>
+#include <memory>
+#include <random>
 #include <vector>
 
 
@@ -15,11 +22,30 @@ template <typename T> T clamp_val(T val, T min, T max) {
   return val;
 }
 
+// Lets the caches derived from the heightmap (layer pyramid, baked climate,
+// flow receivers) know which cells changed
+static void HeightChanged(int x0, int y0, int x1, int y1) {
+  LayerPyramid::MarkDirty(LayerPyramid::LAYER_HEIGHT, x0, y0, x1, y1);
+  ClimateSim::MarkTerrainDirty(x0, y0, x1, y1);
+  HydrologySim::MarkTerrainDirty(x0, y0, x1, y1);
+}
+
+static void HeightChanged() {
+  LayerPyramid::MarkLayerDirty(LayerPyramid::LAYER_HEIGHT);
+  ClimateSim::MarkTerrainDirty();
+  HydrologySim::MarkTerrainDirty();
+}
+
 // Forward declaration for HeightmapLoader logic
 void LoadHeightmapData(const char *path, WorldBuffers &buffers, uint32_t count);
 
 void TerrainController::GenerateHeightmap(WorldBuffers &b,
                                           const WorldSettings &s) {
+  if (s.worldType == TEMPLATE_TECTONIC) {
+    GenerateTectonicPlates(b, s);
+    return;
+  }
+
   FastNoiseLite noise;
   noise.SetSeed(s.seed);
   noise.SetFractalType(FastNoiseLite::FractalType_FBm);
@@ -87,89 +113,298 @@ void TerrainController::GenerateHeightmap(WorldBuffers &b,
 
     b.height[i] = clamp_val(h, 0.0f, 1.0f);
   }
+  HeightChanged();
+}
+
+// --- PLATE TECTONICS ---
+// Seeds N plates, grows them with a parallel frontier flood fill, then
+// advects crust along each plate's velocity for a few geological steps.
+// Converging boundaries pile up mountains (or trenches where oceanic crust
+// subducts), diverging boundaries open rifts.
+
+namespace {
+struct Plate {
+  int seedCell;
+  float vx, vy;     // Cells per geological step
+  float baseCrust;  // Starting elevation of the plate
+  float growth;     // Flood fill expansion probability per round
+  bool oceanic;
+  std::vector<int> cells;
+};
+
+uint32_t HashCell(uint32_t a, uint32_t b) {
+  uint32_t h = a * 0x9E3779B1u ^ (b + 0x7F4A7C15u + (a << 6) + (a >> 2));
+  h ^= h >> 16;
+  h *= 0x85EBCA6Bu;
+  h ^= h >> 13;
+  h *= 0xC2B2AE35u;
+  h ^= h >> 16;
+  return h;
 }
 
+const int CLAIM_EMPTY = INT_MAX;
+const int CLAIM_TAKEN = -2;
+
+// Grows plates from their seeds. Every round each frontier cell may push its
+// plate into free 4-neighbours; contested cells go to the lowest hashed key,
+// so the result does not depend on thread count or frontier order.
+void FloodFillPlates(std::vector<Plate> &plates, std::vector<int> &owner,
+                     int side) {
+  int count = side * side;
+  std::unique_ptr<std::atomic<int>[]> claim(new std::atomic<int>[count]);
+  for (int i = 0; i < count; ++i)
+    claim[i].store(CLAIM_EMPTY, std::memory_order_relaxed);
+
+  std::vector<int> frontier;
+  for (int p = 0; p < (int)plates.size(); ++p) {
+    owner[plates[p].seedCell] = p;
+    claim[plates[p].seedCell].store(CLAIM_TAKEN);
+    frontier.push_back(plates[p].seedCell);
+  }
+
+  const int grain = 2048;
+  const int dx[4] = {1, -1, 0, 0};
+  const int dy[4] = {0, 0, 1, -1};
+
+  for (uint32_t round = 0; !frontier.empty(); ++round) {
+    int fSize = (int)frontier.size();
+    auto Expands = [&](int f) {
+      const Plate &pl = plates[owner[f]];
+      return (HashCell((uint32_t)f, round) & 0xFFFF) < pl.growth * 65536.0f;
+    };
+
+    // Phase A: bid on free neighbours
+    ThreadPool::ParallelFor(0, fSize, grain, [&](int lo, int hi) {
+      for (int k = lo; k < hi; ++k) {
+        int f = frontier[k];
+        if (!Expands(f))
+          continue;
+        int p = owner[f];
+        int x = f % side, y = f / side;
+        for (int d = 0; d < 4; ++d) {
+          int nx = x + dx[d], ny = y + dy[d];
+          if (nx < 0 || nx >= side || ny < 0 || ny >= side)
+            continue;
+          int n = ny * side + nx;
+          if (owner[n] != -1)
+            continue;
+          int key = (int)((HashCell((uint32_t)n, (uint32_t)p) & 0x7FFF) << 8) | p;
+          int cur = claim[n].load(std::memory_order_relaxed);
+          while (key < cur && !claim[n].compare_exchange_weak(cur, key)) {
+          }
+        }
+      }
+    });
+
+    // Phase B: winners take their cells, build the next frontier per chunk
+    int chunks = (fSize + grain - 1) / grain;
+    std::vector<std::vector<int>> nextParts(chunks);
+    ThreadPool::ParallelFor(0, fSize, grain, [&](int lo, int hi) {
+      std::vector<int> &out = nextParts[lo / grain];
+      for (int k = lo; k < hi; ++k) {
+        int f = frontier[k];
+        if (!Expands(f)) {
+          out.push_back(f); // Stalled this round, try again next round
+          continue;
+        }
+        int x = f % side, y = f / side;
+        for (int d = 0; d < 4; ++d) {
+          int nx = x + dx[d], ny = y + dy[d];
+          if (nx < 0 || nx >= side || ny < 0 || ny >= side)
+            continue;
+          int n = ny * side + nx;
+          int key = claim[n].load();
+          if (key == CLAIM_EMPTY || key == CLAIM_TAKEN)
+            continue;
+          if (claim[n].compare_exchange_strong(key, CLAIM_TAKEN)) {
+            owner[n] = key & 0xFF;
+            out.push_back(n);
+          }
+        }
+      }
+    });
+
+    frontier.clear();
+    for (auto &part : nextParts)
+      frontier.insert(frontier.end(), part.begin(), part.end());
+  }
+
+  for (int i = 0; i < count; ++i) {
+    if (owner[i] < 0)
+      owner[i] = 0; // Unreachable (should not happen on a full grid)
+    plates[owner[i]].cells.push_back(i);
+  }
+}
+
+// Separable box blur used to spread boundary stress into mountain belts
+void BoxBlur(std::vector<float> &field, std::vector<float> &tmp, int side,
+             int radius) {
+  float norm = 1.0f / (float)(radius * 2 + 1);
+  ThreadPool::ParallelFor(0, side, 16, [&](int lo, int hi) {
+    for (int y = lo; y < hi; ++y) {
+      const float *row = &field[y * side];
+      float sum = 0.0f;
+      for (int x = -radius; x <= radius; ++x)
+        sum += row[clamp_val(x, 0, side - 1)];
+      for (int x = 0; x < side; ++x) {
+        tmp[y * side + x] = sum * norm;
+        sum += row[std::min(x + radius + 1, side - 1)] -
+               row[std::max(x - radius, 0)];
+      }
+    }
+  });
+  ThreadPool::ParallelFor(0, side, 16, [&](int lo, int hi) {
+    for (int x = lo; x < hi; ++x) {
+      float sum = 0.0f;
+      for (int y = -radius; y <= radius; ++y)
+        sum += tmp[clamp_val(y, 0, side - 1) * side + x];
+      for (int y = 0; y < side; ++y) {
+        field[y * side + x] = sum * norm;
+        sum += tmp[std::min(y + radius + 1, side - 1) * side + x] -
+               tmp[std::max(y - radius, 0) * side + x];
+      }
+    }
+  });
+}
+} // namespace
+
 void TerrainController::GenerateTectonicPlates(WorldBuffers &b,
                                                const WorldSettings &s) {
   std::cout << "[DEBUG] Generating Tectonic Plates..." << std::endl;
   int side = (int)std::sqrt(b.count);
   if (side <= 0)
     return;
+  int count = side * side;
+
+  // 1. Seed plates
+  std::mt19937 rng((uint32_t)s.seed);
+  std::uniform_real_distribution<float> uni(0.0f, 1.0f);
+  int plateCount = clamp_val(s.plateCount, 2, 64);
+
+  std::vector<Plate> plates(plateCount);
+  std::vector<int> owner(count, -1);
+  for (int p = 0; p < plateCount; ++p) {
+    Plate &pl = plates[p];
+    do {
+      pl.seedCell = (int)(uni(rng) * (count - 1));
+    } while (owner[pl.seedCell] != -1);
+    owner[pl.seedCell] = p;
+
+    float angle = uni(rng) * 6.2831853f;
+    float speed = 0.3f + uni(rng) * 0.9f;
+    pl.vx = std::cos(angle) * speed;
+    pl.vy = std::sin(angle) * speed;
+    pl.oceanic = uni(rng) < 0.4f;
+    pl.baseCrust = pl.oceanic ? 0.2f + uni(rng) * 0.1f
+                              : 0.5f + uni(rng) * 0.1f;
+    pl.growth = 0.5f + uni(rng) * 0.5f;
+  }
+  std::fill(owner.begin(), owner.end(), -1);
 
-  // 1. Primary Plates (Large Continents)
-  FastNoiseLite continentNoise;
-  continentNoise.SetNoiseType(FastNoiseLite::NoiseType_Cellular);
-  continentNoise.SetCellularDistanceFunction(
-      FastNoiseLite::CellularDistanceFunction_Euclidean);
-  continentNoise.SetCellularReturnType(
-      FastNoiseLite::CellularReturnType_Distance2); // Distance to edge
-  continentNoise.SetFrequency(0.003f);              // Large plates
-  continentNoise.SetSeed(s.seed);
-  continentNoise.SetCellularJitter(1.2f); // Organic shapes
-
-  // 2. Secondary Plates (Breakup)
-  FastNoiseLite breakupNoise;
-  breakupNoise.SetNoiseType(FastNoiseLite::NoiseType_Cellular);
-  breakupNoise.SetCellularReturnType(
-      FastNoiseLite::CellularReturnType_CellValue);
-  breakupNoise.SetFrequency(0.01f);
-  breakupNoise.SetSeed(s.seed + 1);
-
-  // 3. Detail Noise (Roughness)
+  // 2. Parallel flood fill
+  FloodFillPlates(plates, owner, side);
+
+  // 3. Initial crust
   FastNoiseLite detail;
+  detail.SetSeed(s.seed);
   detail.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
   detail.SetFrequency(0.02f);
   detail.SetFractalType(FastNoiseLite::FractalType_FBm);
   detail.SetFractalOctaves(3);
 
-  // 4. Warp Noise (Distortion)
-  FastNoiseLite warp;
-  warp.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
-  warp.SetFrequency(0.005f);
-
-  for (int i = 0; i < (int)b.count; ++i) {
-    int x = i % side;
-    int y = i / side;
-
-    float wx = (float)x;
-    float wy = (float)y;
-    float wForce = 40.0f;
-    float wn = warp.GetNoise(wx, wy);
-    wx += wn * wForce;
-    wy += wn * wForce;
-
-    // Plate math
-    float distToEdge = continentNoise.GetNoise(wx, wy); // -1 to 1 range usually
-    distToEdge = (distToEdge + 1.0f) * 0.5f;            // 0 to 1
-
-    // Invert: 1.0 is center of plate, 0.0 is edge
-    float plateHeight = distToEdge;
-
-    // Add breakup
-    float breakup = breakupNoise.GetNoise(wx, wy);
-
-    // Continental Shelf Logic
-    float finalHeight = 0.0f;
-
-    // If we are "on a plate"
-    if (plateHeight > 0.15f) {
-      // Land
-      finalHeight = 0.2f + (plateHeight * 0.8f); // Base lift
-
-      // Mountain Ranges at collision zones (edges of high randomness)
-      if (breakup > 0.5f) {
-        finalHeight += (breakup - 0.5f) * 0.5f;
+  std::vector<float> crust(count), nextCrust(count);
+  std::vector<float> stress(count), tmp(count);
+  ThreadPool::ParallelFor(0, count, 16384, [&](int lo, int hi) {
+    for (int i = lo; i < hi; ++i)
+      crust[i] = plates[owner[i]].baseCrust +
+                 detail.GetNoise((float)(i % side), (float)(i / side)) * 0.08f;
+  });
+
+  // 4. Boundary stress
+  // Plate footprints stay where the flood fill put them (crust drifts inside
+  // them, ownership does not move), so the boundaries and their stress are
+  // the same on every step: detect them once and spread them into belts.
+  ThreadPool::ParallelFor(0, side, 32, [&](int lo, int hi) {
+    for (int y = lo; y < hi; ++y) {
+      for (int x = 0; x < side; ++x) {
+        int i = y * side + x;
+        const Plate &pa = plates[owner[i]];
+        float st = 0.0f;
+        for (int ny = y - 1; ny <= y + 1; ++ny) {
+          for (int nx = x - 1; nx <= x + 1; ++nx) {
+            if (nx < 0 || nx >= side || ny < 0 || ny >= side)
+              continue;
+            int q = owner[ny * side + nx];
+            if (q == owner[i])
+              continue;
+            const Plate &pb = plates[q];
+            float ddx = (float)(nx - x), ddy = (float)(ny - y);
+            float inv = 1.0f / std::sqrt(ddx * ddx + ddy * ddy);
+            float closing =
+                ((pa.vx - pb.vx) * ddx + (pa.vy - pb.vy) * ddy) * inv;
+            if (closing > 0.0f) {
+              if (pa.oceanic && !pb.oceanic)
+                st -= closing * 0.7f; // Subduction trench
+              else
+                st += closing * (pa.oceanic ? 0.6f : 1.5f); // Orogeny
+            } else {
+              st += closing * 0.6f; // Rift
+            }
+          }
+        }
+        stress[i] = st;
       }
-    } else {
-      // Ocean
-      finalHeight = plateHeight; // Deep trench at 0
     }
+  });
+  BoxBlur(stress, tmp, side, 10);
+
+  // 5. Geological steps
+  const float oceanFloor = 0.18f; // Fresh crust at a rift
+  int steps = clamp_val(s.plateSteps, 1, 64);
+  for (int step = 0; step < steps; ++step) {
+    // 5a. Drift crust along each plate's velocity (one task per plate)
+    ThreadPool::ParallelFor(0, plateCount, 1, [&](int lo, int hi) {
+      for (int p = lo; p < hi; ++p) {
+        const Plate &pl = plates[p];
+        for (int i : pl.cells) {
+          float sx = clamp_val((float)(i % side) - pl.vx, 0.0f, side - 1.001f);
+          float sy = clamp_val((float)(i / side) - pl.vy, 0.0f, side - 1.001f);
+          int x0 = (int)sx, y0 = (int)sy;
+          int src = (int)(sy + 0.5f) * side + (int)(sx + 0.5f);
+          if (owner[src] != p) {
+            // Trailing edge pulled away from its neighbour: rift
+            nextCrust[i] = crust[i] * 0.5f + oceanFloor * 0.5f;
+            continue;
+          }
+          float fx = sx - x0, fy = sy - y0;
+          int i00 = y0 * side + x0;
+          float top = crust[i00] * (1.0f - fx) + crust[i00 + 1] * fx;
+          float bot =
+              crust[i00 + side] * (1.0f - fx) + crust[i00 + side + 1] * fx;
+          nextCrust[i] = top * (1.0f - fy) + bot * fy;
+        }
+      }
+    });
 
-    // Detail
-    finalHeight += detail.GetNoise((float)x, (float)y) * 0.05f;
-
-    b.height[i] = clamp_val(finalHeight, 0.0f, 1.0f);
+    // 5b. Boundary uplift, trenches and rifts
+    ThreadPool::ParallelFor(0, count, 16384, [&](int lo, int hi) {
+      for (int i = lo; i < hi; ++i)
+        crust[i] = clamp_val(nextCrust[i] + stress[i] * 0.5f, 0.0f, 1.5f);
+    });
   }
+
+  // 6. Final relief
+  for (int i = 0; i < count; ++i)
+    b.height[i] = crust[i];
+  SmoothTerrain(b, side);
+  ThreadPool::ParallelFor(0, count, 16384, [&](int lo, int hi) {
+    for (int i = lo; i < hi; ++i) {
+      float d = detail.GetNoise((float)(i % side) * 3.0f,
+                                (float)(i / side) * 3.0f);
+      b.height[i] = clamp_val(b.height[i] + d * 0.03f, 0.0f, 1.0f);
+    }
+  });
+  HeightChanged();
 }
 
 // --- NEW FEATURES ---
@@ -222,11 +457,12 @@ void TerrainController::LoadHeightmapFromImageWithKeys(
     WorldBuffers &b, const std::string &filepath,
     const std::vector<ColorKey> &keys) {
   LoadHeightmapDataWithKeys(filepath.c_str(), b, b.count, keys);
+  HeightChanged();
 }
 
 #include "../../include/AssetManager.hpp" // Needed for AutoPopulate
 
-void TerrainController::AutoPopulate(WorldBuffers &b, const WorldSettings &s) {
+void TerrainController::AutoPopulate(WorldBuffers &b, const WorldSettings &) {
   b.ClearAgents(); // Assuming this exists or we do it manually
   for (int i = 0; i < (int)b.count; ++i) {
     b.population[i] = 0;
@@ -258,8 +494,9 @@ void TerrainController::AutoPopulate(WorldBuffers &b, const WorldSettings &s) {
       continue; // Biome not found in rules
 
     // 2. Identify Potential Habitats
-    // Skip water for now unless we add aquatic agents
-    if (biome->minHeight < s.seaLevel)
+    // Skip water for now unless we add aquatic agents (biome heights are
+    // relative to sea level, see BiomeTable)
+    if (biome->maxHeight <= 0.0f)
       continue;
 
     // 3. Find Suitable Agents
@@ -339,11 +576,13 @@ void TerrainController::ApplyBrush(WorldBuffers &b, int width, int cx, int cy,
       b.height[idx] = clamp_val(b.height[idx], 0.0f, 1.0f);
     }
   }
+  HeightChanged(cx - rInt, cy - rInt, cx + rInt + 1, cy + rInt + 1);
 }
 
 void TerrainController::LoadHeightmapFromImage(WorldBuffers &b,
                                                const std::string &filepath) {
   LoadHeightmapData(filepath.c_str(), b, b.count);
+  HeightChanged();
 }
 
 void TerrainController::ApplyThermalErosion(WorldBuffers &b, int iterations) {
@@ -374,6 +613,7 @@ void TerrainController::ApplyThermalErosion(WorldBuffers &b, int iterations) {
       }
     }
   }
+  HeightChanged();
 }
 
 void TerrainController::EnforceOceanEdges(WorldBuffers &b, int side,
@@ -392,6 +632,7 @@ void TerrainController::EnforceOceanEdges(WorldBuffers &b, int side,
       mask = 1;
     b.height[i] *= mask;
   }
+  HeightChanged();
 }
 
 void TerrainController::SmoothTerrain(WorldBuffers &b, int side) {
@@ -413,6 +654,7 @@ void TerrainController::SmoothTerrain(WorldBuffers &b, int side) {
   }
   for (int i = 0; i < (int)b.count; ++i)
     b.height[i] = nextH[i];
+  HeightChanged();
 }
 
 void TerrainController::RoughenCoastlines(WorldBuffers &b, int side,
@@ -426,8 +668,7 @@ void TerrainController::RoughenCoastlines(WorldBuffers &b, int side,
     }
     b.height[i] = clamp_val(b.height[i], 0.0f, 1.0f);
   }
-
-
+  HeightChanged();
 }
 
 void TerrainController::GenerateClimate(WorldBuffers &b,
@@ -0,0 +1,157 @@
+#include "../../include/ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ThreadPool {
+
+// --- POOL STATE ---
+static std::vector<std::thread> workers;
+static std::mutex poolMutex;     // Guards job publication / worker wakeup
+static std::mutex dispatchMutex; // One ParallelFor in flight at a time
+static std::condition_variable wakeCv;
+static std::condition_variable doneCv;
+static bool stopping = false;
+static bool jobLive = false; // Workers may only join while this is set
+static int activeRunners = 0; // Workers currently inside RunChunks
+static unsigned long long generation = 0;
+
+// Current job (valid while a ParallelFor is running)
+static const std::function<void(int, int)> *jobFn = nullptr;
+static int jobBegin = 0;
+static int jobEnd = 0;
+static int jobGrain = 1;
+static int jobChunks = 0;
+static std::atomic<int> nextChunk{0};
+static std::atomic<int> chunksDone{0};
+
+static thread_local bool insideJob = false;
+
+// Pulls chunks until the job is drained
+static void RunChunks() {
+  insideJob = true;
+  for (;;) {
+    int c = nextChunk.fetch_add(1);
+    if (c >= jobChunks)
+      break;
+    int lo = jobBegin + c * jobGrain;
+    int hi = std::min(jobEnd, lo + jobGrain);
+    (*jobFn)(lo, hi);
+    chunksDone.fetch_add(1);
+  }
+  insideJob = false;
+}
+
+static void WorkerLoop() {
+  unsigned long long seen = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(poolMutex);
+      wakeCv.wait(lock, [&] { return stopping || generation != seen; });
+      if (stopping)
+        return;
+      seen = generation;
+      if (!jobLive)
+        continue; // Woke after the job already finished
+      ++activeRunners;
+    }
+    RunChunks();
+    {
+      std::lock_guard<std::mutex> lock(poolMutex);
+      --activeRunners;
+    }
+    doneCv.notify_all();
+  }
+}
+
+static void StartWorkers() {
+  if (!workers.empty())
+    return;
+  // SAGA_THREADS overrides the detected core count (1 = fully serial)
+  int hw = (int)std::thread::hardware_concurrency();
+  const char *env = std::getenv("SAGA_THREADS");
+  if (env && std::atoi(env) > 0)
+    hw = std::atoi(env);
+  int extra = (hw > 1) ? hw - 1 : 0;
+  stopping = false;
+  for (int i = 0; i < extra; ++i)
+    workers.emplace_back(WorkerLoop);
+}
+
+int WorkerCount() {
+  std::lock_guard<std::mutex> lock(dispatchMutex);
+  StartWorkers();
+  return (int)workers.size() + 1;
+}
+
+void ParallelFor(int begin, int end, int grain,
+                 const std::function<void(int, int)> &fn) {
+  if (end <= begin)
+    return;
+  if (grain < 1)
+    grain = 1;
+  int chunks = (end - begin + grain - 1) / grain;
+
+  // Single chunk or nested call: no point waking anyone
+  if (chunks == 1 || insideJob) {
+    for (int lo = begin; lo < end; lo += grain)
+      fn(lo, std::min(end, lo + grain));
+    return;
+  }
+
+  std::lock_guard<std::mutex> dispatch(dispatchMutex);
+  StartWorkers();
+  if (workers.empty()) {
+    for (int lo = begin; lo < end; lo += grain)
+      fn(lo, std::min(end, lo + grain));
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    jobFn = &fn;
+    jobBegin = begin;
+    jobEnd = end;
+    jobGrain = grain;
+    jobChunks = chunks;
+    nextChunk.store(0);
+    chunksDone.store(0);
+    jobLive = true;
+    ++generation;
+  }
+  wakeCv.notify_all();
+
+  // The calling thread works too
+  RunChunks();
+
+  std::unique_lock<std::mutex> lock(poolMutex);
+  doneCv.wait(lock, [&] {
+    return chunksDone.load() >= jobChunks && activeRunners == 0;
+  });
+  jobLive = false;
+  jobFn = nullptr;
+}
+
+void Shutdown() {
+  std::lock_guard<std::mutex> dispatch(dispatchMutex);
+  {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    stopping = true;
+  }
+  wakeCv.notify_all();
+  for (auto &t : workers)
+    t.join();
+  workers.clear();
+  stopping = false;
+}
+
+// Joins the workers before the statics above are torn down at exit
+static struct PoolGuard {
+  ~PoolGuard() { Shutdown(); }
+} poolGuard;
+
+} // namespace ThreadPool
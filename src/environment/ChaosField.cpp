@@ -1,7 +1,10 @@
 #include "../../include/AssetManager.hpp"
+#include "../../include/DiffusionSolver.hpp"
 #include "../../include/SimulationModules.hpp"
+#include "../../include/ThreadPool.hpp"
 #include <algorithm>
-#include <cstring> // For memcpy
+#include <cmath>
+#include <utility>
 #include <vector>
 
 
@@ -13,25 +16,157 @@ struct Rift {
 };
 std::vector<Rift> activeRifts;
 
+static const float MUTANT_CHAOS = 0.8f;          // Chaos needed to spawn mutants
+static const uint32_t MUTANT_STREAM = 0x4D555431u; // CellRandom stream
+static uint32_t chaosTick = 0;
+static std::vector<std::vector<int>> hotCells; // Per tile row, see Update
+
+// --- LONG STEPS ---
+// With WorldSettings::chaosIntervalTicks > 1, calls in between only count
+// ticks; the last one advances the whole interval in one implicit solve with
+// the sources held at their value.
+static int pendingTicks = 0;
+static std::vector<int> sources;     // Cells stamped this call
+static std::vector<uint8_t> sourceMask;
+
+// --- ACTIVE TILES ---
+// Chaos only lives near its sources. Tiles whose chaos fell below
+// CHAOS_EPSILON are zeroed in both buffers and skipped; a tick diffuses the
+// live tiles plus the neighbours they can spill into, which is as far as
+// chaos spreads per tick. tileLive holds one bit per 3x3 neighbour (centre =
+// the tile itself). A neighbour only gets its bit when the facing edge or
+// corner holds enough chaos to lift it past CHAOS_EPSILON this tick;
+// otherwise it would just be diffused and flushed again.
+static const int TILE_SHIFT = 5;
+static const float CHAOS_EPSILON = 1e-3f;
+static std::vector<uint16_t> tileLive;
+static std::vector<uint8_t> tileRun;
+static int tilesX = 0, cellSide = 0;
+static bool allLive = true;
+
+static uint16_t SpreadBit(int dx, int dy) {
+  return (uint16_t)(1 << ((dy + 1) * 3 + dx + 1));
+}
+
+// Raised cells on a tile edge may spill into that neighbour straight away
+void MarkActive(int index) {
+  if (index < 0 || index >= cellSide * cellSide)
+    return;
+  int x = index % cellSide, y = index / cellSide;
+  const int T = 1 << TILE_SHIFT;
+  int dx = (x % T == 0) ? -1 : (x % T == T - 1) ? 1 : 0;
+  int dy = (y % T == 0) ? -1 : (y % T == T - 1) ? 1 : 0;
+  tileLive[(y >> TILE_SHIFT) * tilesX + (x >> TILE_SHIFT)] |=
+      SpreadBit(0, 0) | SpreadBit(dx, 0) | SpreadBit(0, dy) | SpreadBit(dx, dy);
+}
+
+void MarkAllActive() { allLive = true; }
+
 void SpawnRift(WorldBuffers &b, int index, float intensity) {
   if (index < 0 || index >= (int)b.count)
     return;
   activeRifts.push_back({index, intensity});
   if (b.chaos)
     b.chaos[index] = intensity;
+  MarkActive(index);
 }
 
 void ClearRifts() { activeRifts.clear(); }
 
+// Interior cells [x, x1) of one row. Fixed 8-wide blocks keep the inner
+// loop vectorizable even at -O2 (no trip-count or aliasing checks needed).
+static void StencilRow(const float *__restrict up, const float *__restrict mid,
+                       const float *__restrict down, float *__restrict out,
+                       int x, int x1, float rate, float decay) {
+  const int LANES = 8;
+  for (; x + LANES <= x1; x += LANES)
+    for (int k = 0; k < LANES; ++k) {
+      int c = x + k;
+      float neighborSum = up[c - 1] + up[c] + up[c + 1] + mid[c - 1] +
+                          mid[c + 1] + down[c - 1] + down[c] + down[c + 1];
+      out[c] = (mid[c] + (neighborSum * 0.125f - mid[c]) * rate) * decay;
+    }
+  for (; x < x1; ++x) {
+    float neighborSum = up[x - 1] + up[x] + up[x + 1] + mid[x - 1] +
+                        mid[x + 1] + down[x - 1] + down[x] + down[x + 1];
+    out[x] = (mid[x] + (neighborSum * 0.125f - mid[x]) * rate) * decay;
+  }
+}
+
+// Sparse pass over the hot cells
+static void SpawnMutants(WorldBuffers &b, const WorldSettings &s,
+                         float chance) {
+  if (!b.cultureID || !b.population || AssetManager::agentRegistry.empty())
+    return;
+  // The last agent added; cultureID holds agent IDs, not registry indices
+  int mutantID = AssetManager::agentRegistry.back().id;
+  uint32_t stream = HashMix((uint32_t)s.seed ^ MUTANT_STREAM);
+  for (const auto &list : hotCells)
+    for (int i : list) {
+      if (b.cultureID[i] == -1 && CellRandom(i, chaosTick, stream) < chance) {
+        b.cultureID[i] = mutantID;
+        b.population[i] = 50; // Spawn a pack of mutants
+        FactionStats::Enter(b, i);
+      }
+    }
+}
+
+// Advances 'ticks' ticks in one backward-Euler solve with the sources held
+// fixed. Stable at any length, where the explicit stencil needs every tick.
+static void SolveInterval(WorldBuffers &b, int side, int ticks, float rate,
+                          float decay) {
+  sourceMask.assign(b.count, 0);
+  for (int idx : sources)
+    sourceMask[idx] = 1;
+  DiffusionSolver::Params p;
+  p.rate = rate;
+  p.decay = 1.0f - decay;
+  p.ticks = (float)ticks;
+  DiffusionSolver::Solve(b.chaos, side, p, sourceMask.data());
+  MarkAllActive(); // The solve reaches past the live tiles
+
+  const int T = 1 << TILE_SHIFT;
+  hotCells.resize(tilesX);
+  ThreadPool::ParallelFor(0, tilesX, 1, [&](int tyLo, int tyHi) {
+    for (int ty = tyLo; ty < tyHi; ++ty) {
+      std::vector<int> &hot = hotCells[ty];
+      hot.clear();
+      for (int y = ty * T; y < std::min(side, (ty + 1) * T); ++y)
+        for (int x = 0; x < side; ++x)
+          if (b.chaos[y * side + x] > MUTANT_CHAOS)
+            hot.push_back(y * side + x);
+    }
+  });
+}
+
 void Update(WorldBuffers &b, const NeighborGraph &g, const WorldSettings &s) {
   if (!b.chaos || !g.neighborData)
     return;
 
   int side = (int)std::sqrt(b.count);
+  if (side != cellSide) {
+    cellSide = side;
+    tilesX = (side + (1 << TILE_SHIFT) - 1) >> TILE_SHIFT;
+    tileLive.assign((size_t)tilesX * tilesX, 0);
+    allLive = true;
+  }
   float angleOffset = s.convergenceAngle;
   int cx = side / 2;
   int cy = side / 2;
 
+  ++pendingTicks;
+  if (s.chaosIntervalTicks > 1 && pendingTicks < s.chaosIntervalTicks)
+    return;
+  int ticks = pendingTicks;
+  pendingTicks = 0;
+
+  sources.clear();
+  auto stamp = [&](int idx, float value) {
+    b.chaos[idx] = value;
+    MarkActive(idx);
+    sources.push_back(idx);
+  };
+
   // 112 points along 12 paths converging to center
   for (int p = 0; p < 12; ++p) {
     float pathAngle = (p * (3.14159f * 2.0f) / 12.0f) + angleOffset;
@@ -41,59 +176,148 @@ void Update(WorldBuffers &b, const NeighborGraph &g, const WorldSettings &s) {
       int py = cy + (int)(sin(pathAngle) * dist);
 
       if (px >= 0 && px < side && py >= 0 && py < side) {
-        int idx = py * side + px;
-        b.chaos[idx] = 1.0f; // Max chaos at source points
+        stamp(py * side + px, 1.0f); // Max chaos at source points
       }
     }
   }
 
   // Convergence point
-  b.chaos[cy * side + cx] = 1.0f;
+  stamp(cy * side + cx, 1.0f);
   // 1. EMIT CHAOS (Source)
   for (const auto &rift : activeRifts) {
-    if (rift.index >= 0 && rift.index < (int)b.count) {
-      b.chaos[rift.index] = rift.intensity;
-    }
+    if (rift.index >= 0 && rift.index < (int)b.count)
+      stamp(rift.index, rift.intensity);
   }
 
-  // 2. DIFFUSION (Gas simulation)
-  static std::vector<float> nextChaos;
-  if (nextChaos.size() != b.count)
-    nextChaos.resize(b.count);
-
-  float diffusionRate = 0.1f;
-  float decayRate = 0.98f; // Magic fades over distance
+  const float diffusionRate = 0.1f;
+  const float decayRate = 0.98f; // Magic fades over distance
+  if (ticks > 1) {
+    SolveInterval(b, side, ticks, diffusionRate, decayRate);
+    chaosTick += ticks;
+    // Chance of at least one spawn over the interval
+    SpawnMutants(b, s,
+                 1.0f - std::pow(1.0f - s.mutantSpawnChance, (float)ticks));
+    return;
+  }
 
-  for (uint32_t i = 0; i < b.count; ++i) {
-    float current = b.chaos[i];
+  // 2. DIFFUSION (Gas simulation)
+  // Each cell moves towards the mean of its 8 neighbours (fewer on the map
+  // edge) and decays. Interior rows are a straight 3x3 stencil the compiler
+  // vectorizes; edge cells go through the neighbour graph.
+  if (!b.nextChaos)
+    return;
+  const float *chaos = b.chaos;
+  float *next = b.nextChaos;
 
-    // Get average of neighbors
-    float neighborSum = 0.0f;
-    int offset = g.offsetTable[i];
+  auto edgeCell = [&](int i) {
+    float current = chaos[i];
     int count = g.countTable[i];
-
-    for (int k = 0; k < count; ++k) {
-      int nIdx = g.neighborData[offset + k];
-      neighborSum += b.chaos[nIdx];
-    }
-
     if (count > 0) {
-      float avg = neighborSum / count;
-      // Move towards average (Diffusion)
-      current += (avg - current) * diffusionRate;
+      const int *n = g.neighborData + g.offsetTable[i];
+      float neighborSum = 0.0f;
+      for (int k = 0; k < count; ++k)
+        neighborSum += chaos[n[k]];
+      current += (neighborSum / count - current) * diffusionRate;
     }
+    next[i] = current * decayRate;
+  };
+
+  // A cell receives at most three edge cells' worth, an eighth each
+  const float spillLevel = CHAOS_EPSILON * 8.0f / (3.0f * diffusionRate * decayRate);
 
-    nextChaos[i] = current * decayRate;
+  // Live tiles and the neighbours they spill into run this tick
+  tileRun.assign(tileLive.size(), allLive ? 1 : 0);
+  if (!allLive)
+    for (int ty = 0; ty < tilesX; ++ty)
+      for (int tx = 0; tx < tilesX; ++tx) {
+        uint16_t spread = tileLive[ty * tilesX + tx];
+        if (!spread)
+          continue;
+        for (int dy = -1; dy <= 1; ++dy)
+          for (int dx = -1; dx <= 1; ++dx) {
+            int nx = tx + dx, ny = ty + dy;
+            if ((spread & SpreadBit(dx, dy)) && nx >= 0 && ny >= 0 &&
+                nx < tilesX && ny < tilesX)
+              tileRun[ny * tilesX + nx] = 1;
+          }
+      }
 
-    // Mutants spawning
-    if (current > 0.8f && b.cultureID[i] == -1 && (rand() % 10000) / 10000.0f < s.mutantSpawnChance) {
-      b.cultureID[i] = AssetManager::agentRegistry.size() - 1; // Default mutant is the last one we added
-      b.population[i] = 50; // Spawn a pack of mutants
+  const int T = 1 << TILE_SHIFT;
+  hotCells.resize(tilesX);
+  ThreadPool::ParallelFor(0, tilesX, 1, [&](int tyLo, int tyHi) {
+    for (int ty = tyLo; ty < tyHi; ++ty) {
+      std::vector<int> &hot = hotCells[ty];
+      hot.clear();
+      for (int tx = 0; tx < tilesX; ++tx) {
+        int t = ty * tilesX + tx;
+        if (!tileRun[t])
+          continue;
+        int x0 = tx * T, x1 = std::min(side, x0 + T);
+        int y0 = ty * T, y1 = std::min(side, y0 + T);
+        uint16_t spread = 0;
+        for (int y = y0; y < y1; ++y) {
+          int row = y * side;
+          if (y == 0 || y == side - 1) {
+            for (int x = x0; x < x1; ++x)
+              edgeCell(row + x);
+          } else {
+            if (x0 == 0)
+              edgeCell(row);
+            if (x1 == side)
+              edgeCell(row + side - 1);
+            StencilRow(chaos + row - side, chaos + row, chaos + row + side,
+                       next + row, std::max(x0, 1), std::min(x1, side - 1),
+                       diffusionRate, decayRate);
+          }
+          // Counting (not branching) keeps these scans vectorizable
+          int live = 0, spill = 0, hotHere = 0;
+          for (int x = x0; x < x1; ++x) {
+            live += next[row + x] >= CHAOS_EPSILON;
+            spill += next[row + x] >= spillLevel;
+            hotHere += next[row + x] > MUTANT_CHAOS * decayRate;
+          }
+          if (live)
+            spread |= SpreadBit(0, 0);
+          if (spill) {
+            int dy = (y == y0) ? -1 : (y == y1 - 1) ? 1 : 0;
+            spread |= SpreadBit(0, dy);
+            if (next[row + x0] >= spillLevel)
+              spread |= SpreadBit(-1, 0) | SpreadBit(-1, dy);
+            if (next[row + x1 - 1] >= spillLevel)
+              spread |= SpreadBit(1, 0) | SpreadBit(1, dy);
+          }
+          // Mutants only appear where chaos (before decay) is above 0.8
+          for (int x = x0; hotHere && x < x1; ++x)
+            if (next[row + x] > MUTANT_CHAOS * decayRate) {
+              hot.push_back(row + x);
+              --hotHere;
+            }
+        }
+        tileLive[t] = spread;
+      }
     }
-  }
+  });
+
+  // Flush tiles that died in both buffers, so skipping them stays exact
+  ThreadPool::ParallelFor(0, tilesX, 1, [&](int tyLo, int tyHi) {
+    for (int ty = tyLo; ty < tyHi; ++ty)
+      for (int tx = 0; tx < tilesX; ++tx) {
+        int t = ty * tilesX + tx;
+        if (!tileRun[t] || tileLive[t])
+          continue;
+        int x0 = tx * T, x1 = std::min(side, x0 + T);
+        for (int y = ty * T; y < std::min(side, (ty + 1) * T); ++y) {
+          std::fill(b.chaos + y * side + x0, b.chaos + y * side + x1, 0.0f);
+          std::fill(next + y * side + x0, next + y * side + x1, 0.0f);
+        }
+      }
+  });
+  std::swap(b.chaos, b.nextChaos);
+  allLive = false;
 
-  // Apply back
-  std::memcpy(b.chaos, nextChaos.data(), b.count * sizeof(float));
+  // 3. MUTANTS
+  ++chaosTick;
+  SpawnMutants(b, s, s.mutantSpawnChance);
 }
 
 } // namespace ChaosField
@@ -1,7 +1,12 @@
+#include "../../include/AssetManager.hpp"
 #include "../../include/Environment.hpp"
 #include "../../include/FastNoiseLite.h"
+#include "../../include/LayerPyramid.hpp"
+#include "../../include/ThreadPool.hpp"
 #include <algorithm>
 #include <cmath>
+#include <cstdlib>
+#include <vector>
 
 namespace ClimateSim {
 template <typename T> T clamp_val(T val, T min, T max) {
@@ -12,146 +17,759 @@ template <typename T> T clamp_val(T val, T min, T max) {
   return val;
 }
 
-// Helper: Whittaker Diagram Lookup
-int GetBiome(float temp, float moisture) {
-  if (temp < 0.1f)
-    return BiomeType::SNOW;
-  if (temp < 0.2f)
-    return BiomeType::TUNDRA;
-  if (temp < 0.4f) {
-    if (moisture < 0.3f)
-      return BiomeType::BARE;
-    if (moisture < 0.6f)
-      return BiomeType::SHRUBLAND;
-    return BiomeType::TEMPERATE_DECIDUOUS_FOREST;
+// --- BAKED BASE FIELDS ---
+// Everything that only depends on terrain and the static climate settings.
+// Season and global modifiers are layered on top in Update().
+static std::vector<float> baseTemp;     // Latitude + altitude + noise
+static std::vector<float> baseMoisture; // Orographic sweep + noise, pre-raininess
+
+// --- CALENDAR TABLES ---
+// One quantized field per calendar season ([season * count + cell]); a tick
+// blends the current season into the next. Tides use one field per cell.
+static const float SEASON_TEMP_STEP = 0.3f / 127.0f;
+static const float SEASON_MOIST_STEP = 0.15f / 127.0f;
+static const float TIDE_MOISTURE = 0.05f;
+static std::vector<int8_t> seasonTemp;
+static std::vector<int8_t> seasonMoisture;
+static std::vector<uint8_t> tideExposure; // Low-lying coast, 0-255
+static std::vector<uint8_t> biomeHeight;  // BiomeTable height band per cell
+static std::vector<float> seasonWarmth;   // -1 (midwinter) .. +1 (midsummer)
+
+// --- COARSE MODE ---
+// Bake on a grid 'coarseScale' cells coarser (block-mean heights), keeping
+// only sea-level temperature and land moisture. A solve upsamples them and
+// applies altitude, season and tide per full-res cell, so of the full-res
+// tables above only biomeHeight is kept.
+static int coarseScale = 1;
+static int coarseSide = 0;
+static std::vector<float> coarseHeight;
+static std::vector<float> coarseTemp;     // Latitude + noise, no altitude
+static std::vector<float> coarseMoisture; // Orographic sweep + noise
+static std::vector<int> colLo, colHi;     // Bilinear taps per full-res column
+static std::vector<float> colW;
+
+// --- SOLVE INTERVAL ---
+static bool solved = false;
+static uint32_t solveCount = 0;
+static int lastSolveDay = 0;
+static float lastGlobalTemp = 0.0f, lastRaininess = 0.0f;
+
+// --- INCREMENTAL BIOMES ---
+// Each cell remembers the (temp, moisture) margin step it was classified at
+// and how far it may drift from it (BiomeTable::Margin). It is only
+// reclassified once it drifts that far plus BIOME_HYSTERESIS, when its
+// chaos state flips, or when its tile is dirty (terrain or rules changed).
+static const int BIOME_TILE_SHIFT = 5; // 32x32 cell tiles
+static const int BIOME_HYSTERESIS = 2; // Extra margin steps before a flip
+static const uint8_t CHAOS_BIT = 0x80; // anchorState: margin | CHAOS_BIT
+static std::vector<uint8_t> anchorTemp, anchorMoist, anchorState;
+static std::vector<uint8_t> biomeTileDirty;
+static int biomeTilesX = 0;
+static bool allTilesDirty = true;
+static bool biomesReset = false;
+static std::vector<BiomeTransition> transitions;
+static std::vector<std::vector<BiomeTransition>> chunkTransitions;
+
+struct BakeKey {
+  const float *height = nullptr;
+  uint32_t count = 0;
+  float seaLevel = 0.0f;
+  float tempZones[3] = {};
+  float windDir[5] = {};
+  float windStr[5] = {};
+  std::vector<int> seasonStarts; // Calendar layout the tables were baked for
+  int daysPerYear = 0;
+  int resolution = 1;
+  int biomeRevision = 0; // biomeHeight is only valid for this table
+};
+static BakeKey bakedKey;
+static bool baked = false;
+
+// Pending terrain edit (bounding box, empty when x0 >= x1)
+static int dirtyX0 = 0, dirtyY0 = 0, dirtyX1 = 0, dirtyY1 = 0;
+
+static BakeKey MakeKey(const WorldBuffers &b, const WorldSettings &s) {
+  BakeKey k;
+  k.height = b.height;
+  k.count = b.count;
+  k.seaLevel = s.seaLevel;
+  k.tempZones[0] = s.tempZonePolar;
+  k.tempZones[1] = s.tempZoneTemperate;
+  k.tempZones[2] = s.tempZoneTropical;
+  for (int z = 0; z < 5; ++z) {
+    k.windDir[z] = s.windZonesDir[z];
+    k.windStr[z] = s.windZonesStr[z];
   }
-  if (temp < 0.7f) {
-    if (moisture < 0.2f)
-      return BiomeType::TEMPERATE_DESERT;
-    if (moisture < 0.5f)
-      return BiomeType::GRASSLAND;
-    if (moisture < 0.8f)
-      return BiomeType::TEMPERATE_DECIDUOUS_FOREST;
-    return BiomeType::TEMPERATE_RAIN_FOREST;
+  const CalendarDef &cal = AssetManager::calendar;
+  for (int n = 0; n < (int)cal.seasons.size(); ++n)
+    k.seasonStarts.push_back(cal.SeasonStartDay(n));
+  k.daysPerYear = cal.DaysPerYear();
+  k.resolution = clamp_val(s.climateResolution, 1, 16);
+  k.biomeRevision = AssetManager::biomeTable.revision;
+  return k;
+}
+
+static bool SameKey(const BakeKey &a, const BakeKey &b) {
+  if (a.height != b.height || a.count != b.count || a.seaLevel != b.seaLevel)
+    return false;
+  for (int z = 0; z < 3; ++z)
+    if (a.tempZones[z] != b.tempZones[z])
+      return false;
+  for (int z = 0; z < 5; ++z)
+    if (a.windDir[z] != b.windDir[z] || a.windStr[z] != b.windStr[z])
+      return false;
+  return a.seasonStarts == b.seasonStarts && a.daysPerYear == b.daysPerYear &&
+         a.resolution == b.resolution && a.biomeRevision == b.biomeRevision;
+}
+
+// --- 1. TEMPERATURE (3-ZONE LERP) ---
+static float RowTemp(const WorldSettings &s, float lat) {
+  if (lat < 0.5f) {
+    float alpha = lat / 0.5f;
+    return (s.tempZonePolar * (1.0f - alpha) + s.tempZoneTemperate * alpha) *
+           1.5f; // Boost impact
   }
-  // Hot
-  if (moisture < 0.2f)
-    return BiomeType::SCORCHED;
-  if (moisture < 0.4f)
-    return BiomeType::SUBTROPICAL_DESERT;
-  if (moisture < 0.7f)
-    return BiomeType::TROPICAL_SEASONAL_FOREST;
-  return BiomeType::TROPICAL_RAIN_FOREST;
+  float alpha = (lat - 0.5f) / 0.5f;
+  return (s.tempZoneTemperate * (1.0f - alpha) + s.tempZoneTropical * alpha) *
+         1.5f;
 }
 
-void Update(WorldBuffers &b, const WorldSettings &s, const ChronosConfig &c) {
-  int side = (int)std::sqrt(b.count);
-  if (side == 0)
-    return;
+// --- 2. WIND (5-ZONE MAPPING) ---
+static void RowWind(const WorldSettings &s, float lat, float &windX,
+                    float &windY) {
+  int windZoneIdx = clamp_val((int)(lat * 5.0f), 0, 4);
+  float localWindStrength = s.windZonesStr[windZoneIdx];
+  windX = std::cos(s.windZonesDir[windZoneIdx]) * localWindStrength;
+  windY = std::sin(s.windZonesDir[windZoneIdx]) * localWindStrength;
+}
 
-  // Noise generators for variation
+// --- SEASONAL / TIDAL RESPONSE ---
+// Oceans damp the swing and poles feel it most; summer brings rain to the
+// tropical rows. Tides only reach coast just above sea level.
+inline float SeasonSwing(float lat, bool ocean) {
+  return 0.15f * (ocean ? 0.5f : 1.0f) * (1.5f - lat);
+}
+inline float WetSeason(float lat, bool ocean) { return ocean ? 0.0f : 0.1f * lat; }
+inline float TideFlat(float h, float seaLevel, bool ocean) {
+  float flat = ocean ? 0.0f : 1.0f - (h - seaLevel) / 0.03f;
+  return clamp_val(flat, 0.0f, 1.0f);
+}
+
+// Bakes cells [x0,x1) of rows [y0,y1)
+static void BakeRect(WorldBuffers &b, const WorldSettings &s, int side, int x0,
+                     int y0, int x1, int y1) {
+  // Noise generators for variation (GetNoise is const, safe to share)
   FastNoiseLite tempNoise;
   tempNoise.SetFrequency(0.003f);
+  float invSea = 1.0f / std::max(1e-6f, s.seaLevel);
+  float invLand = 1.0f / std::max(1e-6f, 1.0f - s.seaLevel);
+  const BiomeTable &biomes = AssetManager::biomeTable;
+
+  ThreadPool::ParallelFor(y0, y1, 8, [&](int rowLo, int rowHi) {
+    for (int y = rowLo; y < rowHi; ++y) {
+      float lat = (float)y / side; // 0.0 (N) to 1.0 (S)
+      float rowTemp = RowTemp(s, lat);
+      float windX, windY;
+      RowWind(s, lat, windX, windY);
+      int seasons = (int)seasonWarmth.size();
+
+      for (int x = x0; x < x1; ++x) {
+        int i = y * side + x;
+        float h = b.height[i];
+
+        // Altitude (higher is colder) + noise
+        float altMod = std::max(0.0f, h - s.seaLevel) * 0.8f;
+        float nT = tempNoise.GetNoise((float)x, (float)y) * 0.1f;
+        baseTemp[i] = rowTemp - altMod + nT;
+
+        b.windDX[i] = windX;
+        b.windDY[i] = windY;
+
+        // --- SEASONAL / TIDAL TABLES ---
+        bool ocean = h <= s.seaLevel;
+        float swing = SeasonSwing(lat, ocean);
+        float wetSeason = WetSeason(lat, ocean);
+        for (int k = 0; k < seasons; ++k) {
+          float w = seasonWarmth[k];
+          seasonTemp[(size_t)k * b.count + i] =
+              (int8_t)std::lround(swing * w / SEASON_TEMP_STEP);
+          seasonMoisture[(size_t)k * b.count + i] =
+              (int8_t)std::lround(wetSeason * w / SEASON_MOIST_STEP);
+        }
+        tideExposure[i] = (uint8_t)(TideFlat(h, s.seaLevel, ocean) * 255.0f);
+        float elev = (h - s.seaLevel) * (ocean ? invSea : invLand);
+        biomeHeight[i] = (uint8_t)biomes.HeightBand(elev, ocean);
+      }
+    }
+  });
+}
+
+// --- 3. MOISTURE (OROGRAPHIC SWEEP) ---
+// Air parcels march downwind one cell at a time along straight lines. Over
+// ocean they soak up moisture, over land they drizzle a little per step and
+// rain hard wherever the ground rises under them, so windward slopes get wet
+// and the lee of a range dries out. Each wind zone owns the rows of its
+// latitude band; a parcel crosses whatever terrain lies upwind (even in other
+// bands) but only deposits inside its own. Lines never share cells, so they
+// run in parallel.
+static const float SWEEP_EVAPORATION = 0.15f; // Ocean recharge per step
+static const float SWEEP_DRIZZLE = 0.004f;    // Rain-out per land step
+static const float SWEEP_LIFT = 6.0f;         // Extra rain-out per unit rise
+static const float SWEEP_RAIN_GAIN = 8.0f;    // Deposited rain -> moisture
+
+// Rows [lo,hi) of wind zone z
+static void ZoneRows(int side, int z, int &lo, int &hi) {
+  lo = side;
+  hi = 0;
+  for (int y = 0; y < side; ++y) {
+    int zone = clamp_val((int)((float)y / side * 5.0f), 0, 4);
+    if (zone == z) {
+      lo = std::min(lo, y);
+      hi = y + 1;
+    }
+  }
+}
+
+// Sweeps one zone over a side x side height grid whose cells are 'scale'
+// full-res cells wide. Skips the zone unless its lines cross rows [y0,y1) on
+// the way to its band.
+static void SweepZone(const WorldSettings &s, const float *height, float *moist,
+                      int side, int scale, int z, int y0, int y1,
+                      const FastNoiseLite &rainNoise) {
+  int rowLo, rowHi;
+  ZoneRows(side, z, rowLo, rowHi);
+  if (rowLo >= rowHi)
+    return;
+  float str = s.windZonesStr[z];
+  float wx = std::cos(s.windZonesDir[z]) * str;
+  float wy = std::sin(s.windZonesDir[z]) * str;
+  float seaLevel = s.seaLevel;
+  // Noise is sampled at the cell centre in full-res coordinates
+  float noiseOfs = (scale - 1) * 0.5f;
+  auto noise = [&](int x, int y) {
+    return rainNoise.GetNoise(x * scale + noiseOfs, y * scale + noiseOfs);
+  };
+
+  // Still air: nothing is carried, land only sees the local baseline
+  if (std::fabs(wx) < 1e-4f && std::fabs(wy) < 1e-4f) {
+    if (y1 <= rowLo || y0 >= rowHi)
+      return;
+    ThreadPool::ParallelFor(rowLo, rowHi, 8, [&](int lo, int hi) {
+      for (int y = lo; y < hi; ++y)
+        for (int x = 0; x < side; ++x) {
+          int i = y * side + x;
+          moist[i] = (height[i] <= seaLevel)
+                         ? 1.0f
+                         : -0.1f + noise(x, y) * 0.2f;
+        }
+    });
+    return;
+  }
+
+  // March along the dominant axis from the upwind edge; the minor axis
+  // drifts by 'slope' cells per step. Line j is offset by j on the minor
+  // axis, so every cell lies on exactly one line.
+  bool alongX = std::fabs(wx) >= std::fabs(wy);
+  float major = alongX ? wx : wy;
+  float slope = (alongX ? wy : wx) / std::fabs(major);
+  int dir = major > 0.0f ? 1 : -1;
+  auto shift = [slope](int k) { return (int)std::floor(k * slope + 0.5f); };
+  int drift = shift(side - 1);
+  int spanLo = alongX ? rowLo : 0, spanHi = alongX ? rowHi : side;
+  int jLo = spanLo - std::max(0, drift), jHi = spanHi - std::min(0, drift);
+  int readLo = rowLo, readHi = rowHi;
+  if (alongX)
+    (drift > 0 ? readLo : readHi) -= drift;
+  else
+    (dir > 0 ? readLo : readHi) = (dir > 0) ? 0 : side;
+  if (y1 <= readLo || y0 >= readHi)
+    return;
+  // Weaker wind carries moisture a shorter distance; coarse steps cover
+  // 'scale' cells at once
+  float drizzle = SWEEP_DRIZZLE * scale / std::max(0.1f, std::fabs(str));
+  float evaporation = 1.0f - std::pow(1.0f - SWEEP_EVAPORATION, (float)scale);
+  float rainGain = SWEEP_RAIN_GAIN / scale; // Rain per cell, not per step
+
+  // Both coordinates move monotonically along a line, so once it leaves the
+  // map or the band downwind it never comes back
+  ThreadPool::ParallelFor(jLo, jHi, 16, [&](int lo, int hi) {
+    for (int j = lo; j < hi; ++j) {
+      float q = 1.0f; // Air enters saturated from the sea beyond the edge
+      float hPrev = seaLevel;
+      bool onMap = false, inBand = false;
+      for (int k = 0; k < side; ++k) {
+        int a = (dir > 0) ? k : side - 1 - k; // Major-axis coordinate
+        int m = j + shift(k);
+        if (m < 0 || m >= side) {
+          if (onMap)
+            break;
+          continue;
+        }
+        onMap = true;
+        int x = alongX ? a : m;
+        int y = alongX ? m : a;
+        int i = y * side + x;
+        float h = height[i];
+        bool deposit = y >= rowLo && y < rowHi;
+        if (inBand && !deposit)
+          break;
+        inBand = deposit;
+        if (h <= seaLevel) {
+          q += (1.0f - q) * evaporation;
+          hPrev = seaLevel;
+          if (deposit)
+            moist[i] = 1.0f;
+          continue;
+        }
+        float rise = std::max(0.0f, h - hPrev);
+        float rain = q * std::min(1.0f, drizzle + rise * SWEEP_LIFT);
+        q -= rain;
+        hPrev = h;
+        if (deposit)
+          moist[i] = 0.7f * q - 0.1f + rain * rainGain +
+                     noise(x, y) * 0.2f;
+      }
+    }
+  });
+}
+
+// Re-sweeps every zone whose result can depend on rows [y0,y1)
+static void SweepMoisture(const WorldSettings &s, const float *height,
+                          float *moist, int side, int scale, int y0, int y1) {
   FastNoiseLite rainNoise;
   rainNoise.SetFrequency(0.005f);
+  for (int z = 0; z < 5; ++z)
+    SweepZone(s, height, moist, side, scale, z, y0, y1, rainNoise);
+}
 
-    // Seasonal temp modifiers: 0=Spring, 1=Summer, 2=Autumn, 3=Winter
-  float seasonMod = 0.0f;
-  if (c.currentSeason == 1) seasonMod = 0.15f; // Summer
-  else if (c.currentSeason == 3) seasonMod = -0.15f; // Winter
-
-  for (int i = 0; i < (int)b.count; ++i) {
-    int x = i % side;
-    int y = i / side;
-    float h = b.height[i];
-
-    // --- 1. TEMPERATURE (3-ZONE LERP) ---
-    float lat = (float)y / side; // 0.0 (N) to 1.0 (S)
-    float baseTemp = 0.0f;
-
-    if (lat < 0.5f) {
-      float alpha = lat / 0.5f;
-      baseTemp =
-          (s.tempZonePolar * (1.0f - alpha) + s.tempZoneTemperate * alpha) *
-          1.5f; // Boost impact
-    } else {
-      float alpha = (lat - 0.5f) / 0.5f;
-      baseTemp =
-          (s.tempZoneTemperate * (1.0f - alpha) + s.tempZoneTropical * alpha) *
-          1.5f;
+// Coarse bake: block-mean heights, then temperature and swept moisture at
+// coarse cell centres. Cheap enough to redo in full on any terrain edit.
+static void BakeCoarse(WorldBuffers &b, const WorldSettings &s, int side) {
+  int r = coarseScale;
+  int cs = (side + r - 1) / r;
+  coarseSide = cs;
+  coarseHeight.assign((size_t)cs * cs, 0.0f);
+  coarseTemp.assign((size_t)cs * cs, 0.0f);
+  coarseMoisture.assign((size_t)cs * cs, 0.0f);
+
+  FastNoiseLite tempNoise;
+  tempNoise.SetFrequency(0.003f);
+  float centre = (r - 1) * 0.5f;
+  ThreadPool::ParallelFor(0, cs, 4, [&](int rowLo, int rowHi) {
+    for (int cy = rowLo; cy < rowHi; ++cy) {
+      int fy0 = cy * r, fy1 = std::min(side, fy0 + r);
+      float fy = cy * r + centre;
+      float rowTemp = RowTemp(s, fy / side);
+      for (int cx = 0; cx < cs; ++cx) {
+        int fx0 = cx * r, fx1 = std::min(side, fx0 + r);
+        float sum = 0.0f;
+        for (int y = fy0; y < fy1; ++y)
+          for (int x = fx0; x < fx1; ++x)
+            sum += b.height[y * side + x];
+        int c = cy * cs + cx;
+        coarseHeight[c] = sum / (float)((fy1 - fy0) * (fx1 - fx0));
+        coarseTemp[c] =
+            rowTemp + tempNoise.GetNoise(cx * r + centre, fy) * 0.1f;
+      }
     }
+  });
+  SweepMoisture(s, coarseHeight.data(), coarseMoisture.data(), cs, r, 0, cs);
 
-        // Modifier: Altitude (Higher is colder)
-    float altMod = std::max(0.0f, h - s.seaLevel) * 0.8f;
-    // Modifier: Noise
-    float nT = tempNoise.GetNoise((float)x, (float)y) * 0.1f;
+  // Wind per row; the biome height band stays per cell like in full mode
+  biomeHeight.resize(b.count);
+  float invSea = 1.0f / std::max(1e-6f, s.seaLevel);
+  float invLand = 1.0f / std::max(1e-6f, 1.0f - s.seaLevel);
+  const BiomeTable &biomes = AssetManager::biomeTable;
+  ThreadPool::ParallelFor(0, side, 8, [&](int rowLo, int rowHi) {
+    for (int y = rowLo; y < rowHi; ++y) {
+      float windX, windY;
+      RowWind(s, (float)y / side, windX, windY);
+      std::fill(b.windDX + (size_t)y * side, b.windDX + (size_t)(y + 1) * side,
+                windX);
+      std::fill(b.windDY + (size_t)y * side, b.windDY + (size_t)(y + 1) * side,
+                windY);
+      for (int i = y * side; i < (y + 1) * side; ++i) {
+        float h = b.height[i];
+        bool ocean = h <= s.seaLevel;
+        float elev = (h - s.seaLevel) * (ocean ? invSea : invLand);
+        biomeHeight[i] = (uint8_t)biomes.HeightBand(elev, ocean);
+      }
+    }
+  });
 
-    b.temperature[i] = clamp_val(baseTemp - altMod + nT + seasonMod, 0.0f, 1.0f);
+  // Full-res coordinate -> two coarse taps and the weight of the second
+  colLo.resize(side);
+  colHi.resize(side);
+  colW.resize(side);
+  for (int x = 0; x < side; ++x) {
+    float u = (x + 0.5f) / r - 0.5f;
+    int c0 = clamp_val((int)std::floor(u), 0, cs - 1);
+    colLo[x] = c0;
+    colHi[x] = std::min(c0 + 1, cs - 1);
+    colW[x] = clamp_val(u - (float)c0, 0.0f, 1.0f);
+  }
+}
 
-    // --- 2. WIND (5-ZONE MAPPING) ---
-    int windZoneIdx = clamp_val((int)(lat * 5.0f), 0, 4);
-    float localWindAngle = s.windZonesDir[windZoneIdx];
-    float localWindStrength = s.windZonesStr[windZoneIdx];
+// --- BIOME TILES ---
+static void MarkBiomeTiles(int side, int x0, int y0, int x1, int y1) {
+  if (biomeTileDirty.empty())
+    return; // Nothing classified yet, the first solve does everything
+  int tilesY = (int)biomeTileDirty.size() / biomeTilesX;
+  int tx0 = std::max(0, x0) >> BIOME_TILE_SHIFT;
+  int ty0 = std::max(0, y0) >> BIOME_TILE_SHIFT;
+  int tx1 = std::min(biomeTilesX, ((std::min(side, x1) - 1) >> BIOME_TILE_SHIFT) + 1);
+  int ty1 = std::min(tilesY, ((std::min(side, y1) - 1) >> BIOME_TILE_SHIFT) + 1);
+  for (int ty = ty0; ty < ty1; ++ty)
+    for (int tx = tx0; tx < tx1; ++tx)
+      biomeTileDirty[ty * biomeTilesX + tx] = 1;
+}
 
-    float windX = std::cos(localWindAngle) * localWindStrength;
-    float windY = std::sin(localWindAngle) * localWindStrength;
+static void MarkAllBiomeTiles() {
+  std::fill(biomeTileDirty.begin(), biomeTileDirty.end(), 1);
+  allTilesDirty = true;
+}
 
-    b.windDX[i] = windX;
-    b.windDY[i] = windY;
+// Sizes the per-cell anchors for b and opens a pass (one transition list per
+// row chunk, merged in chunk order so the result is deterministic)
+static void BeginBiomePass(const WorldBuffers &b, int side, int rowGrain) {
+  if (anchorState.size() != b.count) {
+    anchorTemp.assign(b.count, 0);
+    anchorMoist.assign(b.count, 0);
+    anchorState.assign(b.count, 0);
+    biomeTilesX = (side + (1 << BIOME_TILE_SHIFT) - 1) >> BIOME_TILE_SHIFT;
+    biomeTileDirty.assign((size_t)biomeTilesX * biomeTilesX, 1);
+    allTilesDirty = true;
+  }
+  biomesReset = allTilesDirty;
+  chunkTransitions.resize((side + rowGrain - 1) / rowGrain);
+  for (auto &list : chunkTransitions)
+    list.clear();
+}
 
-    // --- 3. MOISTURE (RAIN SHADOW LOGIC) ---
-    float moisture = 0.0f;
+static void EndBiomePass() {
+  transitions.clear();
+  for (auto &list : chunkTransitions)
+    transitions.insert(transitions.end(), list.begin(), list.end());
+  std::fill(biomeTileDirty.begin(), biomeTileDirty.end(), 0);
+  allTilesDirty = false;
+}
+
+// Shared by both solves, run on each row once its climate is written
+struct BiomePass {
+  const BiomeTable &table;
+  const float *temp, *moist, *chaos;
+  int *biomeID;
+  uint8_t *aTemp, *aMoist, *aState;
+  bool reset;
+
+  void Reclassify(int i, int band, std::vector<BiomeTransition> &out) const {
+    float t = temp[i], m = moist[i];
+    bool warped = chaos && chaos[i] > 0.7f;
+    int tq = BiomeTable::MarginStep(t), mq = BiomeTable::MarginStep(m);
+    aTemp[i] = (uint8_t)tq;
+    aMoist[i] = (uint8_t)mq;
+    aState[i] = (uint8_t)(table.Margin(band, tq, mq) | (warped ? CHAOS_BIT : 0));
+    int biome = warped ? BiomeTable::CHAOS_ID : table.Classify(t, m, band);
+    int old = biomeID[i];
+    if (biome == old)
+      return;
+    biomeID[i] = biome;
+    if (!reset)
+      out.push_back({(uint32_t)i, old, biome});
+  }
+
+  // Cells [i0,i1) of one tile row (at most one tile wide); band[k] belongs
+  // to cell i0 + k. The drift test is branch-free so it vectorizes, and
+  // only the few cells that fail it are reclassified.
+  void Span(int i0, int i1, const uint8_t *band, bool tileDirty,
+            std::vector<BiomeTransition> &out) const {
+    if (tileDirty) {
+      for (int i = i0; i < i1; ++i)
+        Reclassify(i, band[i - i0], out);
+      return;
+    }
+    const int R = BiomeTable::MARGIN_RES;
+    static const float calm[1 << BIOME_TILE_SHIFT] = {};
+    const float *warp = chaos ? chaos + i0 : calm;
+    uint8_t stale[1 << BIOME_TILE_SHIFT];
+    int n = i1 - i0, any = 0;
+    for (int k = 0; k < n; ++k) {
+      int i = i0 + k;
+      int tq = std::min(R - 1, (int)(temp[i] * R)); // Solved values are >= 0
+      int mq = std::min(R - 1, (int)(moist[i] * R));
+      int dt = tq - aTemp[i], dm = mq - aMoist[i];
+      int drift = std::max(std::max(dt, -dt), std::max(dm, -dm));
+      int st = aState[i];
+      int warped = warp[k] > 0.7f;
+      stale[k] = (uint8_t)((drift >= (st & 0x7F) + BIOME_HYSTERESIS) |
+                           (warped != (st >> 7)));
+      any |= stale[k];
+    }
+    if (!any)
+      return;
+    for (int k = 0; k < n; ++k)
+      if (stale[k])
+        Reclassify(i0 + k, band[k], out);
+  }
 
-    // Sample upwind
-    int uwX = x - (int)(windX * 15.0f);
-    int uwY = y - (int)(windY * 15.0f);
+  void Row(int y, int side, const uint8_t *band,
+           std::vector<BiomeTransition> &out) const {
+    const uint8_t *tiles = &biomeTileDirty[(y >> BIOME_TILE_SHIFT) * biomeTilesX];
+    const int TILE = 1 << BIOME_TILE_SHIFT;
+    for (int x = 0; x < side; x += TILE) {
+      int x1 = std::min(side, x + TILE);
+      Span(y * side + x, y * side + x1, band + x, tiles[x >> BIOME_TILE_SHIFT] != 0,
+           out);
+    }
+  }
+};
 
-    bool upwindIsOcean = true;
-    float blockage = 0.0f;
+// --- PER-TICK SOLVE (FULL RES) ---
+// One fused pass over the baked arrays (memory bound, so every layer is
+// streamed exactly once); rows are chunked so each cell knows its tile
+static void SolveFull(WorldBuffers &b, int side, int seasonA, int seasonB,
+                      float blend, float tide, float tempOffset,
+                      float rainScale) {
+  const int8_t *tA = &seasonTemp[(size_t)seasonA * b.count];
+  const int8_t *tB = &seasonTemp[(size_t)seasonB * b.count];
+  const int8_t *mA = &seasonMoisture[(size_t)seasonA * b.count];
+  const int8_t *mB = &seasonMoisture[(size_t)seasonB * b.count];
+  float tWa = (1.0f - blend) * SEASON_TEMP_STEP, tWb = blend * SEASON_TEMP_STEP;
+  float mWa = (1.0f - blend) * SEASON_MOIST_STEP, mWb = blend * SEASON_MOIST_STEP;
+  float tideStep = tide / 255.0f;
 
-    if (uwX >= 0 && uwX < side && uwY >= 0 && uwY < side) {
-      int uwIdx = uwY * side + uwX;
-      if (b.height[uwIdx] > s.seaLevel)
-        upwindIsOcean = false;
+  const int ROW_GRAIN = 16;
+  BeginBiomePass(b, side, ROW_GRAIN);
+  BiomePass pass{AssetManager::biomeTable, b.temperature, b.moisture,
+                 b.chaos, b.biomeID, anchorTemp.data(), anchorMoist.data(),
+                 anchorState.data(), biomesReset};
 
-      // Check for mountain obstruction
-      int midX = (x + uwX) / 2;
-      int midY = (y + uwY) / 2;
-      if (midX >= 0 && midX < side && midY >= 0 && midY < side) {
-        int midIdx = midY * side + midX;
-        if (b.height[midIdx] > s.seaLevel + 0.3f) // High peak
-          blockage = 1.0f;
+  const float *bt = baseTemp.data();
+  const float *bm = baseMoisture.data();
+  const uint8_t *tideIn = tideExposure.data();
+  const uint8_t *band = biomeHeight.data();
+  float *temp = b.temperature;
+  float *moist = b.moisture;
+  ThreadPool::ParallelFor(0, side, ROW_GRAIN, [&](int rowLo, int rowHi) {
+    std::vector<BiomeTransition> &out = chunkTransitions[rowLo / ROW_GRAIN];
+    for (int y = rowLo; y < rowHi; ++y) {
+      // Climate first (vectorizes), then the mostly skipped biome check on
+      // the row while it is still in cache
+      int row = y * side;
+      for (int i = row; i < row + side; ++i) {
+        float seasonT = tA[i] * tWa + tB[i] * tWb;
+        float seasonM = mA[i] * mWa + mB[i] * mWb;
+        temp[i] = std::min(1.0f, std::max(0.0f, bt[i] + tempOffset + seasonT));
+        moist[i] = std::min(1.0f, std::max(0.0f, bm[i] * rainScale + seasonM +
+                                                     tideIn[i] * tideStep));
       }
+
+      // --- 4. BIOME CLASSIFICATION (rules table, 5. chaos warping) ---
+      pass.Row(y, side, band + row, out);
     }
+  });
+  EndBiomePass();
+}
 
-    if (h <= s.seaLevel) {
-      moisture = 1.0f;
-    } else {
-      if (upwindIsOcean && blockage < 0.5f)
-        moisture += 0.6f * localWindStrength;
-      else if (blockage > 0.5f)
-        moisture -= 0.4f;
-      else
-        moisture -= 0.1f;
-
-      moisture += rainNoise.GetNoise((float)x, (float)y) * 0.2f;
+// --- PER-TICK SOLVE (COARSE) ---
+// Bilinear upsample of the coarse fields; altitude lapse, season swing and
+// tide use the cell's own height so coasts and peaks stay sharp.
+static void SolveCoarse(WorldBuffers &b, const WorldSettings &s, int side,
+                        float warmth, float tide, float tempOffset,
+                        float rainScale) {
+  int r = coarseScale, cs = coarseSide;
+  float seaLevel = s.seaLevel;
+  const float *ct = coarseTemp.data();
+  const float *cm = coarseMoisture.data();
+  const float *height = b.height;
+  float *temp = b.temperature;
+  float *moist = b.moisture;
+  const int *tapLo = colLo.data(), *tapHi = colHi.data();
+  const float *tapW = colW.data();
+  const int ROW_GRAIN = 16;
+  BeginBiomePass(b, side, ROW_GRAIN);
+  BiomePass pass{AssetManager::biomeTable, b.temperature, b.moisture, b.chaos, b.biomeID,
+                 anchorTemp.data(), anchorMoist.data(), anchorState.data(),
+                 biomesReset};
+  ThreadPool::ParallelFor(0, side, ROW_GRAIN, [&](int rowLo, int rowHi) {
+    std::vector<BiomeTransition> &out = chunkTransitions[rowLo / ROW_GRAIN];
+    // Vertical lerp once per coarse column, then one lerp per cell
+    std::vector<float> rowT(cs), rowM(cs);
+    for (int y = rowLo; y < rowHi; ++y) {
+      float lat = (float)y / side;
+      float v = (y + 0.5f) / r - 0.5f;
+      int r0 = clamp_val((int)std::floor(v), 0, cs - 1);
+      int r1 = std::min(r0 + 1, cs - 1);
+      float wy = clamp_val(v - (float)r0, 0.0f, 1.0f);
+      const float *t0 = ct + (size_t)r0 * cs, *t1 = ct + (size_t)r1 * cs;
+      const float *m0 = cm + (size_t)r0 * cs, *m1 = cm + (size_t)r1 * cs;
+      for (int k = 0; k < cs; ++k) {
+        rowT[k] = t0[k] + (t1[k] - t0[k]) * wy;
+        rowM[k] = m0[k] + (m1[k] - m0[k]) * wy;
+      }
+      float swingLand = SeasonSwing(lat, false) * warmth + tempOffset;
+      float swingSea = SeasonSwing(lat, true) * warmth + tempOffset;
+      float wet = WetSeason(lat, false) * warmth;
+      float seaMoist = std::min(1.0f, std::max(0.0f, rainScale));
+
+      for (int x = 0; x < side; ++x) {
+        int i = y * side + x;
+        int a = tapLo[x], c = tapHi[x];
+        float wx = tapW[x];
+        float baseT = rowT[a] + (rowT[c] - rowT[a]) * wx;
+        float baseM = rowM[a] + (rowM[c] - rowM[a]) * wx;
+
+        float h = height[i];
+        bool ocean = h <= seaLevel;
+        float altMod = std::max(0.0f, h - seaLevel) * 0.8f;
+        float t = std::min(
+            1.0f, std::max(0.0f, baseT - altMod + (ocean ? swingSea : swingLand)));
+        float mLand = std::min(
+            1.0f, std::max(0.0f, baseM * rainScale + wet +
+                                     TideFlat(h, seaLevel, false) * tide));
+        float m = ocean ? seaMoist : mLand;
+        temp[i] = t;
+        moist[i] = m;
+      }
+      pass.Row(y, side, biomeHeight.data() + (size_t)y * side, out);
     }
+  });
+  EndBiomePass();
+}
 
-    // Apply Raininess as a pure multiplier
-    moisture *= (0.5f + s.raininess * 1.5f);
-    b.moisture[i] = clamp_val(moisture, 0.0f, 1.0f);
+void Bake(WorldBuffers &b, const WorldSettings &s) {
+  int side = (int)std::sqrt(b.count);
+  if (side == 0)
+    return;
+  if (AssetManager::biomeTable.cells.empty())
+    AssetManager::CompileBiomeTable(); // Rules were never loaded
+
+  // Season warmth follows the season's start date around the year, so the
+  // default calendar reproduces spring 0 / summer +1 / autumn 0 / winter -1
+  const CalendarDef &cal = AssetManager::calendar;
+  int year = std::max(1, cal.DaysPerYear());
+  seasonWarmth.clear();
+  for (int k = 0; k < (int)cal.seasons.size(); ++k)
+    seasonWarmth.push_back(
+        std::sin(6.2831853f * (float)cal.SeasonStartDay(k) / (float)year));
+  if (seasonWarmth.empty())
+    seasonWarmth.push_back(0.0f); // Seasonless calendar: one neutral table
 
-    // --- 4. BIOME CLASSIFICATION ---
-    if (h <= s.seaLevel) {
-      b.biomeID[i] = BiomeType::OCEAN;
+  coarseScale = clamp_val(s.climateResolution, 1, 16);
+  if (coarseScale > 1) {
+    // Drop the full-res tables; the coarse solve never reads them
+    std::vector<float>().swap(baseTemp);
+    std::vector<float>().swap(baseMoisture);
+    std::vector<int8_t>().swap(seasonTemp);
+    std::vector<int8_t>().swap(seasonMoisture);
+    std::vector<uint8_t>().swap(tideExposure);
+    BakeCoarse(b, s, side);
+  } else {
+    baseTemp.assign(b.count, 0.0f);
+    baseMoisture.assign(b.count, 0.0f);
+    seasonTemp.assign(seasonWarmth.size() * b.count, 0);
+    seasonMoisture.assign(seasonWarmth.size() * b.count, 0);
+    tideExposure.assign(b.count, 0);
+    biomeHeight.assign(b.count, 0);
+    BakeRect(b, s, side, 0, 0, side, side);
+    SweepMoisture(s, b.height, baseMoisture.data(), side, 1, 0, side);
+  }
+  bakedKey = MakeKey(b, s);
+  baked = true;
+  solved = false;
+  dirtyX0 = dirtyX1 = 0;
+  MarkAllBiomeTiles(); // New terrain, settings or rules: classify everything
+}
+
+void MarkTerrainDirty(int x0, int y0, int x1, int y1) {
+  if (x0 >= x1 || y0 >= y1)
+    return;
+  if (dirtyX0 >= dirtyX1) {
+    dirtyX0 = x0;
+    dirtyY0 = y0;
+    dirtyX1 = x1;
+    dirtyY1 = y1;
+    return;
+  }
+  dirtyX0 = std::min(dirtyX0, x0);
+  dirtyY0 = std::min(dirtyY0, y0);
+  dirtyX1 = std::max(dirtyX1, x1);
+  dirtyY1 = std::max(dirtyY1, y1);
+}
+
+void MarkTerrainDirty() { baked = false; }
+
+void Update(WorldBuffers &b, const WorldSettings &s, const ChronosConfig &c) {
+  int side = (int)std::sqrt(b.count);
+  if (side == 0)
+    return;
+
+  if (AssetManager::biomeTable.cells.empty())
+    AssetManager::CompileBiomeTable(); // Rules were never loaded
+  transitions.clear();
+  biomesReset = false;
+  if (!baked || !SameKey(bakedKey, MakeKey(b, s))) {
+    Bake(b, s);
+  } else if (dirtyX0 < dirtyX1) {
+    MarkBiomeTiles(side, dirtyX0, dirtyY0, dirtyX1, dirtyY1);
+    if (coarseScale > 1) {
+      BakeCoarse(b, s, side);
     } else {
-      b.biomeID[i] = GetBiome(b.temperature[i], b.moisture[i]);
+      // Per-cell fields only need the edit itself; moisture re-sweeps the
+      // lines that cross it, which reach downwind to the map edge
+      int y0 = std::max(0, dirtyY0), y1 = std::min(side, dirtyY1);
+      BakeRect(b, s, side, std::max(0, dirtyX0), y0, std::min(side, dirtyX1),
+               y1);
+      SweepMoisture(s, b.height, baseMoisture.data(), side, 1, y0, y1);
     }
+    dirtyX0 = dirtyX1 = 0;
+    solved = false;
+  }
+  // Sediment moved by HydrologySim is too small to warrant a re-bake
 
-    // --- 5. CHAOS WARPING ---
-    if (b.chaos && b.chaos[i] > 0.7f) {
-      b.biomeID[i] = BiomeType::CHAOS_ZONE;
-    }
+  // --- SOLVE INTERVAL ---
+  // Between solves the buffers keep the last result, so hydrology and
+  // disasters act on it for the whole interval
+  int elapsed = c.dayCount - lastSolveDay;
+  if (solved && s.climateIntervalDays > 0 && elapsed >= 0 &&
+      elapsed < s.climateIntervalDays && s.globalTemp == lastGlobalTemp &&
+      s.raininess == lastRaininess)
+    return;
+  solved = true;
+  lastSolveDay = c.dayCount;
+  lastGlobalTemp = s.globalTemp;
+  lastRaininess = s.raininess;
+
+  // --- CALENDAR BLEND ---
+  const CalendarDef &cal = AssetManager::calendar;
+  int seasonB = 0;
+  float blend = 0.0f;
+  int seasonA = cal.SeasonAt(c.dayCount, &seasonB, &blend);
+
+  // Spring tides at new and full moon, averaged over all moons
+  float tide = 0.0f;
+  for (int m = 0; m < (int)cal.moons.size(); ++m)
+    tide += std::cos(12.5663706f * cal.MoonPhase(m, c.dayCount));
+  if (!cal.moons.empty())
+    tide *= TIDE_MOISTURE / (float)cal.moons.size();
+
+  float tempOffset = s.globalTemp * 0.2f;
+  float rainScale = 0.5f + s.raininess * 1.5f; // Raininess as pure multiplier
+
+  if (coarseScale > 1) {
+    float warmth = (1.0f - blend) * seasonWarmth[seasonA] +
+                   blend * seasonWarmth[seasonB];
+    SolveCoarse(b, s, side, warmth, tide, tempOffset, rainScale);
+  } else {
+    SolveFull(b, side, seasonA, seasonB, blend, tide, tempOffset, rainScale);
   }
+
+  LayerPyramid::MarkLayerDirty(LayerPyramid::LAYER_TEMPERATURE);
+  LayerPyramid::MarkLayerDirty(LayerPyramid::LAYER_MOISTURE);
+  solveCount++;
 }
+
+uint32_t SolveCount() { return solveCount; }
+const std::vector<BiomeTransition> &BiomeTransitions() { return transitions; }
+bool BiomesReset() { return biomesReset; }
 } // namespace ClimateSim
@@ -1,19 +1,423 @@
+#include "AssetManager.hpp"
 #include "Environment.hpp"
+#include "LayerPyramid.hpp"
+#include "Lore.hpp"
+#include "Simulation.hpp"
+#include "ThreadPool.hpp"
 #include <algorithm>
 #include <cmath>
-#include <cstdlib>
-#include <iostream>
+#include <string>
+#include <vector>
 
 
 namespace DisasterSystem {
 
-void Trigger(WorldBuffers &b, int type, int index, float strength) {
-  if (index < 0 || index >= (int)b.count)
+// --- ACTIVE EVENTS ---
+// Wildfires, floods and tsunamis play out over ticks. An event only keeps its
+// frontier: the cells it reached last tick, each with the energy it arrived
+// with (fire intensity, water volume or wave height, 1 = as triggered).
+// Fronts only move outwards: a cell joins the next frontier unless it is on
+// the current or the previous one (the fire has burnt its fuel further back).
+// Update grows every frontier in parallel, reading the buffers only, then
+// applies the new cells event by event, so a tick costs the summed frontier
+// size however large the map or the area already hit.
+struct FrontCell {
+  int cell;
+  float energy;
+};
+
+struct Event {
+  int type;
+  float strength;
+  uint32_t serial; // Seeds the event's CellRandom stream
+  int age = 0;
+  std::vector<FrontCell> front, next; // Sorted by cell
+  std::vector<int> behind;            // Previous frontier, sorted
+};
+
+static std::vector<Event> events;
+static uint32_t nextSerial = 1;
+static uint32_t disasterTick = 0;
+static float seaLevel = WorldSettings().seaLevel; // As of the last Update
+
+static const uint32_t DISASTER_STREAM = 0x44534153u; // CellRandom stream
+static const int MAX_EVENT_TICKS = 240;
+static const float FRONT_MIN = 0.02f;     // Energy below which a cell drops
+static const float FIRE_SPREAD = 0.7f;    // Ignition odds: full fuel, bone dry
+static const float FIRE_WET = 0.6f;       // Moisture that stops a fire
+static const float FLORA_FUEL = 1000.0f;  // Flora population of full fuel
+static const float FLOOD_CARRY = 0.9f;    // Volume passed on per tick
+static const float FLOOD_SPILL = 0.3f;    // Share of it spilled onto the banks
+static const float FLOOD_HEAD = 0.01f;    // Water depth per unit volume
+static const float WAVE_HEIGHT = 0.1f;    // Run-up per unit strength
+static const float WAVE_SEA_LOSS = 0.97f; // Energy kept per open-sea cell
+static const float WAVE_LAND_LOSS = 0.8f; // Energy kept per inland cell
+
+static bool Propagates(int type) {
+  return type == 1 || type == 4 || type == 5;
+}
+
+// Flora on the cell as a share of a full stand (0 = nothing to burn)
+static float Fuel(const WorldBuffers &b, int i) {
+  // Read-only here: Grow runs on the pool, so no lazy compile via Species()
+  const SpeciesTable &t = AssetManager::speciesTable;
+  int k = t.Index(b.cultureID ? b.cultureID[i] : -1);
+  if (k == SpeciesTable::NONE || !t.Is(k, SpeciesTable::FLORA))
+    return 0.0f;
+  return std::min(1.0f, (float)b.population[i] / FLORA_FUEL);
+}
+
+// The hydrology receiver, or the lowest lower neighbour before the first
+// hydrology pass
+static int Downhill(const WorldBuffers &b, int side, int i) {
+  const std::vector<int> &receiver = HydrologySim::Receivers();
+  if (receiver.size() == b.count)
+    return receiver[i];
+  int x = i % side, y = i / side, best = -1;
+  float lowest = b.height[i];
+  for (int dy = -1; dy <= 1; ++dy)
+    for (int dx = -1; dx <= 1; ++dx) {
+      int nx = x + dx, ny = y + dy;
+      if ((dx || dy) && nx >= 0 && ny >= 0 && nx < side && ny < side &&
+          b.height[ny * side + nx] < lowest) {
+        best = ny * side + nx;
+        lowest = b.height[best];
+      }
+    }
+  return best;
+}
+
+static bool OnFront(const std::vector<FrontCell> &front, int cell) {
+  auto it = std::lower_bound(
+      front.begin(), front.end(), cell,
+      [](const FrontCell &f, int c) { return f.cell < c; });
+  return it != front.end() && it->cell == cell;
+}
+
+// Builds e.next from e.front. Touches nothing shared but reads, so the
+// events grow side by side.
+static void Grow(const WorldBuffers &b, int side, Event &e) {
+  e.next.clear();
+  uint32_t stream = HashMix(e.serial ^ DISASTER_STREAM);
+  float sea = seaLevel;
+  for (const FrontCell &f : e.front) {
+    int i = f.cell, x = i % side, y = i / side;
+    int down = (e.type == 5) ? Downhill(b, side, i) : -1;
+    float bank = b.height[i] + f.energy * e.strength * FLOOD_HEAD;
+    float wave = f.energy * e.strength * WAVE_HEIGHT;
+    size_t banks = e.next.size();
+
+    for (int dy = -1; dy <= 1; ++dy)
+      for (int dx = -1; dx <= 1; ++dx) {
+        int nx = x + dx, ny = y + dy;
+        if (!(dx || dy) || nx < 0 || ny < 0 || nx >= side || ny >= side)
+          continue;
+        int n = ny * side + nx;
+        if (OnFront(e.front, n) ||
+            std::binary_search(e.behind.begin(), e.behind.end(), n))
+          continue;
+        float rise = b.height[n] - sea;
+        switch (e.type) {
+        case 4: { // Wildfire: spreads over flora, held back by moisture
+          float fuel = Fuel(b, n);
+          float wet = b.moisture ? b.moisture[n] / FIRE_WET : 0.0f;
+          if (fuel <= 0.0f || wet >= 1.0f || rise < 0.0f)
+            break;
+          float odds = FIRE_SPREAD * f.energy * fuel * (1.0f - wet);
+          if (CellRandom(n, disasterTick, stream) < odds)
+            e.next.push_back({n, 0.5f * (f.energy + fuel)});
+        } break;
+        case 5: // Flood: spills onto banks below the water line
+          if (n != down && rise >= 0.0f && b.height[n] <= bank)
+            e.next.push_back({n, 0.0f});
+          break;
+        case 1: // Tsunami: crosses the sea, runs up while it tops the land
+          if (rise < 0.0f)
+            e.next.push_back({n, f.energy * WAVE_SEA_LOSS});
+          else if (rise < wave)
+            e.next.push_back(
+                {n, f.energy * WAVE_LAND_LOSS * (1.0f - rise / wave)});
+          break;
+        }
+      }
+
+    // The water passed on is split between the receiver and the banks, so
+    // a flood only ever shrinks
+    if (e.type == 5) {
+      float carried = f.energy * FLOOD_CARRY;
+      size_t spilled = e.next.size() - banks;
+      bool drains = down >= 0 && b.height[down] >= sea;
+      if (spilled) {
+        float share = (drains ? FLOOD_SPILL : 1.0f) * carried / spilled;
+        for (size_t k = banks; k < e.next.size(); ++k)
+          e.next[k].energy = share;
+      }
+      if (drains)
+        e.next.push_back({down, spilled ? carried * (1.0f - FLOOD_SPILL)
+                                        : carried});
+    }
+  }
+
+  // One entry per cell: converging flood water adds up, fronts keep their
+  // strongest arrival
+  std::sort(e.next.begin(), e.next.end(),
+            [](const FrontCell &l, const FrontCell &r) {
+              return l.cell < r.cell;
+            });
+  size_t out = 0;
+  for (const FrontCell &f : e.next) {
+    if (out && e.next[out - 1].cell == f.cell) {
+      float &energy = e.next[out - 1].energy;
+      energy = (e.type == 5) ? energy + f.energy : std::max(energy, f.energy);
+    } else {
+      e.next[out++] = f;
+    }
+  }
+  e.next.resize(out);
+  e.next.erase(std::remove_if(e.next.begin(), e.next.end(),
+                              [](const FrontCell &f) {
+                                return f.energy < FRONT_MIN;
+                              }),
+               e.next.end());
+}
+
+// Hits the frontier cells and flags the rectangle they span
+static void Apply(WorldBuffers &b, int side, const Event &e) {
+  if (e.front.empty())
     return;
+  int x0 = side, y0 = side, x1 = 0, y1 = 0;
+  for (const FrontCell &f : e.front) {
+    int i = f.cell, x = i % side, y = i / side;
+    float hit = e.strength * f.energy;
+    x0 = std::min(x0, x);
+    y0 = std::min(y0, y);
+    x1 = std::max(x1, x + 1);
+    y1 = std::max(y1, y + 1);
 
+    switch (e.type) {
+    case 1: // Tsunami (Massive Water), where it comes ashore
+      if (b.height[i] < seaLevel)
+        break;
+      if (b.flux)
+        b.flux[i] += hit * 100.0f;
+      if (b.moisture)
+        b.moisture[i] = std::max(b.moisture[i], std::min(1.0f, f.energy));
+      if (b.infrastructure)
+        b.infrastructure[i] = std::max(0.0f, b.infrastructure[i] - hit * 5.0f);
+      if (b.population) {
+        FactionStats::Leave(b, i);
+        b.population[i] = (uint32_t)(b.population[i] *
+                                     (1.0f - std::min(1.0f, f.energy) * 0.5f));
+        FactionStats::Enter(b, i);
+      }
+      break;
+    case 4: // Wildfire (Heat + Dryness), burns the flora it runs through
+      if (b.temperature)
+        b.temperature[i] = std::min(1.0f, b.temperature[i] + hit);
+      if (b.moisture)
+        b.moisture[i] = std::max(0.0f, b.moisture[i] - hit);
+      if (b.infrastructure)
+        b.infrastructure[i] = std::max(0.0f, b.infrastructure[i] - hit);
+      if (Fuel(b, i) > 0.0f) {
+        b.cultureID[i] = -1;
+        b.population[i] = 0;
+      }
+      break;
+    case 5: // Flood (Rain run-off)
+      if (b.flux)
+        b.flux[i] += hit * 50.0f;
+      if (b.moisture)
+        b.moisture[i] = std::min(1.0f, b.moisture[i] + hit * 0.5f);
+      if (b.infrastructure)
+        b.infrastructure[i] = std::max(0.0f, b.infrastructure[i] - hit * 0.5f);
+      break;
+    }
+  }
+
+  LayerPyramid::MarkDirty(LayerPyramid::LAYER_MOISTURE, x0, y0, x1, y1);
+  if (e.type == 4)
+    LayerPyramid::MarkDirty(LayerPyramid::LAYER_TEMPERATURE, x0, y0, x1, y1);
+  if (e.type != 5)
+    LayerPyramid::MarkDirty(LayerPyramid::LAYER_POPULATION, x0, y0, x1, y1);
+}
+
+// --- STAMPS ---
+// Disc footprints, built once per radius: falloff runs from 1 at the centre
+// to 0 on the rim, row by row (dy = -radius .. radius).
+struct Stamp {
+  std::vector<int> halfWidth; // Row dy spans dx in [-halfWidth, halfWidth]
+  std::vector<int> rowStart;  // Row dy's first entry in 'falloff'
+  std::vector<float> falloff;
+};
+static std::vector<Stamp> stamps; // By radius
+
+static const Stamp &GetStamp(int r) {
+  if ((int)stamps.size() <= r)
+    stamps.resize(r + 1);
+  Stamp &st = stamps[r];
+  if (!st.rowStart.empty())
+    return st;
+  for (int dy = -r; dy <= r; ++dy) {
+    int w = 0;
+    while (w < r && (w + 1) * (w + 1) + dy * dy <= r * r)
+      ++w;
+    st.halfWidth.push_back(w);
+    st.rowStart.push_back((int)st.falloff.size());
+    for (int dx = -w; dx <= w; ++dx) {
+      float dist = std::sqrt((float)(dx * dx + dy * dy));
+      st.falloff.push_back(r ? 1.0f - dist / r : 1.0f);
+    }
+  }
+  return st;
+}
+
+// --- BATCHED HITS ---
+// One-off disasters are queued and applied together: Flush sums every hit
+// of the batch into per-row deltas and writes each touched row once,
+// parallel over rows. Overlapping hits add up and are clamped once.
+struct Hit {
+  int type, x, y, radius;
+  float strength;
+  uint32_t stream; // Earthquake jitter
+};
+static std::vector<Hit> pending;
+static const int ROW_GRAIN = 32;
+
+static void Flush(WorldBuffers &b) {
+  if (pending.empty())
+    return;
+  int side = (int)std::sqrt(b.count);
+  int top = side, bottom = 0;
+  for (const Hit &h : pending) {
+    GetStamp(h.radius); // Built here, read-only in the parallel pass
+    top = std::min(top, std::max(0, h.y - h.radius));
+    bottom = std::max(bottom, std::min(side, h.y + h.radius + 1));
+  }
+
+  ThreadPool::ParallelFor(top, bottom, ROW_GRAIN, [&](int rowLo, int rowHi) {
+    std::vector<float> dHeight(side, 0.0f), dMoisture(side, 0.0f),
+        dFlux(side, 0.0f), fluxScale(side, 1.0f), damage(side, 0.0f);
+    // Span of hit h on row y (empty when the row misses it)
+    auto span = [&](const Hit &h, int y, int &lo, int &hi) {
+      int dy = y - h.y;
+      if (dy < -h.radius || dy > h.radius) {
+        lo = hi = 0;
+        return;
+      }
+      int w = stamps[h.radius].halfWidth[dy + h.radius];
+      lo = std::max(0, h.x - w);
+      hi = std::min(side, h.x + w + 1);
+    };
+    for (int y = rowLo; y < rowHi; ++y) {
+      int row = y * side;
+      for (const Hit &h : pending) {
+        int lo, hi;
+        span(h, y, lo, hi);
+        if (lo >= hi)
+          continue;
+        const Stamp &st = stamps[h.radius];
+        int dy = y - h.y;
+        const float *falloff = st.falloff.data() + st.rowStart[dy + h.radius] -
+                               (h.x - st.halfWidth[dy + h.radius]);
+        float s = h.strength;
+        for (int x = lo; x < hi; ++x) {
+          float f = falloff[x];
+          switch (h.type) {
+          case 0: // Earthquake (Noise/Displacement), damages buildings
+            dHeight[x] +=
+                (CellRandom(row + x, disasterTick, h.stream) - 0.5f) * s * f;
+            damage[x] += s * f;
+            break;
+          case 2: // Tornado (Wind + Structure Damage)
+            damage[x] += s * 5.0f * f;
+            break;
+          case 3: // Hurricane (Wind + Rain)
+            dMoisture[x] += s * f;
+            dFlux[x] += s * 50.0f * f;
+            break;
+          case 6: // Drought (Dryness)
+            dMoisture[x] -= s * f;
+            fluxScale[x] *= 1.0f - s * f;
+            break;
+          }
+        }
+      }
+      // Write each span once and reset its deltas (overlaps then add zero)
+      for (const Hit &h : pending) {
+        int lo, hi;
+        span(h, y, lo, hi);
+        for (int x = lo; x < hi; ++x) {
+          int i = row + x;
+          b.height[i] += dHeight[x];
+          if (b.infrastructure)
+            b.infrastructure[i] =
+                std::max(0.0f, b.infrastructure[i] - damage[x]);
+          if (b.moisture)
+            b.moisture[i] =
+                std::min(1.0f, std::max(0.0f, b.moisture[i] + dMoisture[x]));
+          if (b.flux)
+            b.flux[i] = b.flux[i] * fluxScale[x] + dFlux[x];
+          dHeight[x] = dMoisture[x] = dFlux[x] = damage[x] = 0.0f;
+          fluxScale[x] = 1.0f;
+        }
+      }
+    }
+  });
+
+  // Only the stamped squares changed
+  for (const Hit &h : pending) {
+    int r = h.radius, x = h.x, y = h.y;
+    switch (h.type) {
+    case 0:
+      LayerPyramid::MarkDirty(LayerPyramid::LAYER_HEIGHT, x - r, y - r,
+                              x + r + 1, y + r + 1);
+      ClimateSim::MarkTerrainDirty(x - r, y - r, x + r + 1, y + r + 1);
+      HydrologySim::MarkTerrainDirty(x - r, y - r, x + r + 1, y + r + 1);
+      break;
+    case 3:
+    case 6:
+      LayerPyramid::MarkDirty(LayerPyramid::LAYER_MOISTURE, x - r, y - r,
+                              x + r + 1, y + r + 1);
+      break;
+    }
+  }
+  pending.clear();
+}
+
+// Seeds the event's first frontier (hit straight away) and keeps it running
+static void StartEvent(WorldBuffers &b, int type, int index, float strength,
+                       int side, int r) {
+  Event e;
+  e.type = type;
+  e.strength = strength;
+  e.serial = nextSerial++;
+  int x = index % side, y = index / side;
+  // Fires start from a small blaze, floods from the storm's footprint,
+  // tsunamis from the epicentre
+  int reach = (type == 5) ? r : (type == 4) ? std::max(1, r / 4) : 0;
+  const Stamp &st = GetStamp(reach);
+  for (int dy = -reach; dy <= reach; ++dy) {
+    int cy = y + dy, w = st.halfWidth[dy + reach];
+    if (cy < 0 || cy >= side)
+      continue;
+    const float *falloff = st.falloff.data() + st.rowStart[dy + reach];
+    for (int dx = -w; dx <= w; ++dx) {
+      int cx = x + dx, i = cy * side + cx;
+      if (cx < 0 || cx >= side || (type != 1 && b.height[i] < seaLevel))
+        continue;
+      float energy = (type == 5) ? falloff[dx + w] : 1.0f;
+      if (energy >= FRONT_MIN)
+        e.front.push_back({i, energy});
+    }
+  }
+  Apply(b, side, e);
+  if (!e.front.empty())
+    events.push_back(std::move(e));
+}
+
+// Starts an event or queues a one-off hit for the next Flush
+static void Spawn(WorldBuffers &b, int type, int index, float strength) {
   int side = (int)std::sqrt(b.count);
-  int x = index % side;
-  int y = index / side;
 
   // 0: Earthquake, 1: Tsunami, 2: Tornado, 3: Hurricane, 4: Wildfire, 5: Flood,
   // 6: Drought
@@ -22,95 +426,80 @@ void Trigger(WorldBuffers &b, int type, int index, float strength) {
   if (r < 1)
     r = 1;
 
-  for (int cy = y - r; cy <= y + r; ++cy) {
-    for (int cx = x - r; cx <= x + r; ++cx) {
-      if (cx < 0 || cx >= side || cy < 0 || cy >= side)
-        continue;
+  if (Propagates(type))
+    StartEvent(b, type, index, strength, side, r);
+  else if (type >= 0 && type <= 6)
+    pending.push_back({type, index % side, index / side, r, strength,
+                       HashMix(nextSerial++ ^ DISASTER_STREAM)});
+}
 
-      int i = cy * side + cx;
-      float dx = (float)(cx - x);
-      float dy = (float)(cy - y);
-      float dist = std::sqrt(dx * dx + dy * dy);
-      if (dist > r)
-        continue;
-      float falloff = 1.0f - (dist / r);
-
-      switch (type) {
-      case 0: // Earthquake (Noise/Displacement)
-      {
-        float noise = ((rand() % 100) / 100.0f - 0.5f) * strength * falloff;
-        b.height[i] += noise;
-        // Damage buildings
-        if (b.infrastructure)
-          b.infrastructure[i] =
-              std::max(0.0f, b.infrastructure[i] - strength * falloff);
-      } break;
-      case 1: // Tsunami (Massive Water)
-      {
-        if (b.flux)
-          b.flux[i] += strength * 100.0f * falloff;
-      } break;
-      case 2: // Tornado (Wind + Structure Damage)
-      {
-        if (b.infrastructure)
-          b.infrastructure[i] =
-              std::max(0.0f, b.infrastructure[i] - strength * 5.0f * falloff);
-        // Scatter resources?
-      } break;
-      case 3: // Hurricane (Wind + Rain)
-      {
-        if (b.moisture)
-          b.moisture[i] = std::min(1.0f, b.moisture[i] + strength * falloff);
-        if (b.flux)
-          b.flux[i] += strength * 50.0f * falloff;
-      } break;
-      case 4: // Wildfire (Heat + Dryness)
-      {
-        if (b.temperature)
-          b.temperature[i] =
-              std::min(1.0f, b.temperature[i] + strength * falloff);
-        if (b.moisture)
-          b.moisture[i] = std::max(0.0f, b.moisture[i] - strength * falloff);
-        // Kill plants? (Need biology module)
-      } break;
-      case 5: // Flood (Rain)
-      {
-        if (b.flux)
-          b.flux[i] += strength * 50.0f * falloff;
-      } break;
-      case 6: // Drought (Dryness)
-      {
-        if (b.moisture)
-          b.moisture[i] = std::max(0.0f, b.moisture[i] - strength * falloff);
-        if (b.flux)
-          b.flux[i] *= (1.0f - strength * falloff);
-      } break;
-      }
-    }
-  }
+void Trigger(WorldBuffers &b, int type, int index, float strength) {
+  if (index < 0 || index >= (int)b.count)
+    return;
+  Spawn(b, type, index, strength);
+  Flush(b);
+}
+
+void ClearEvents() {
+  events.clear();
+  pending.clear();
 }
 
 void Update(WorldBuffers &b, const WorldSettings &s) {
-  // Check random spawn based on frequency
-  // We can't check every cell every tick for efficiency.
-  // Instead check "Global Chance" once per tick per type.
-
-  auto CheckAndSpawn = [&](const WorldSettings::DisasterSetting &ds, int type) {
-    if (ds.enabled && (rand() % 100000) < (ds.frequency * 100000)) {
-      // Spawn!
-      int idx = rand() % b.count;
-      Trigger(b, type, idx, ds.strength);
-      std::cout << "[DISASTER] " << type << " spawned at " << idx << "\n";
+  seaLevel = s.seaLevel;
+  ++disasterTick;
+
+  // Each type spawns 'frequency' times per tick on average (stress settings
+  // above 1 spawn several at once). Rolls come from CellRandom, so a seed
+  // replays the same disasters.
+  static const char *DISASTER_NAMES[7] = {
+      "An earthquake", "A tsunami", "A tornado", "A hurricane",
+      "A wildfire",    "A flood",   "A drought"};
+  const WorldSettings::DisasterSetting *kinds[7] = {
+      &s.quakeSettings,     &s.tsunamiSettings,  &s.tornadoSettings,
+      &s.hurricaneSettings, &s.wildfireSettings, &s.floodSettings,
+      &s.droughtSettings};
+  uint32_t stream = HashMix((uint32_t)s.seed ^ DISASTER_STREAM);
+  for (int type = 0; type < 7; ++type) {
+    const WorldSettings::DisasterSetting &ds = *kinds[type];
+    if (!ds.enabled || ds.frequency <= 0.0f)
+      continue;
+    int count = (int)ds.frequency;
+    if (CellRandom(type, disasterTick, stream) < ds.frequency - count)
+      ++count;
+    for (int k = 0; k < count; ++k) {
+      uint32_t pick = HashMix(stream + HashMix(disasterTick * 8 + type) + k);
+      int idx = (int)(pick % b.count);
+      Spawn(b, type, idx, ds.strength);
+      LoreScribeNS::LogEvent((int)disasterTick, "DISASTER", idx,
+                             std::string(DISASTER_NAMES[type]) + " struck.");
     }
-  };
-
-  CheckAndSpawn(s.quakeSettings, 0);
-  CheckAndSpawn(s.tsunamiSettings, 1);
-  CheckAndSpawn(s.tornadoSettings, 2);
-  CheckAndSpawn(s.hurricaneSettings, 3);
-  CheckAndSpawn(s.wildfireSettings, 4);
-  CheckAndSpawn(s.floodSettings, 5);
-  CheckAndSpawn(s.droughtSettings, 6);
+  }
+  Flush(b);
+
+  // --- PROPAGATION ---
+  if (events.empty())
+    return;
+  int side = (int)std::sqrt(b.count);
+  ThreadPool::ParallelFor(0, (int)events.size(), 1, [&](int lo, int hi) {
+    for (int k = lo; k < hi; ++k)
+      Grow(b, side, events[k]);
+  });
+  // In trigger order, so overlapping events resolve the same way every run
+  for (Event &e : events) {
+    e.behind.clear();
+    for (const FrontCell &f : e.front)
+      e.behind.push_back(f.cell);
+    std::swap(e.front, e.next);
+    Apply(b, side, e);
+    ++e.age;
+  }
+  events.erase(std::remove_if(events.begin(), events.end(),
+                              [](const Event &e) {
+                                return e.front.empty() ||
+                                       e.age >= MAX_EVENT_TICKS;
+                              }),
+               events.end());
 }
 
 } // namespace DisasterSystem
@@ -1,48 +1,880 @@
 #include "../../include/Environment.hpp"
-#include <cmath>
+#include "../../include/LayerPyramid.hpp"
+#include "../../include/ThreadPool.hpp"
 #include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <istream>
+#include <ostream>
+#include <queue>
+#include <utility>
+#include <vector>
 
 namespace HydrologySim {
+template <typename T> T clamp_val(T val, T min, T max) {
+  if (val < min)
+    return min;
+  if (val > max)
+    return max;
+  return val;
+}
+
+// --- TUNING ---
+static const float RUNOFF_RATE = 0.1f;     // Share of moisture leaving per tick
+static const float EROSION_FLOW = 0.05f;   // Outflow that starts carving
+static const float EROSION_DEPTH = 0.001f; // Sediment moved per carving cell
+static const float FLUX_CARRY = 0.98f;     // Upstream flux kept per hop
+
+// --- RECEIVER CACHE ---
+// Each cell's lowest lower neighbour (-1 = none: ocean or pit). Cached per
+// 32x32 tile and only recomputed where heights changed; a tick reads it
+// before moving anything, so it only depends on the state it started from.
+static const int FLOW_TILE_SHIFT = 5;
+static std::vector<int> receiver;
+static std::vector<uint8_t> tileDirty, tileScratch;
+static int tilesX = 0;
+static bool allDirty = true;
+static const float *routedHeight = nullptr;
+static uint32_t routedCount = 0;
+static float routedSeaLevel = 0.0f;
+static bool routedFilled = false;
+
+// --- DEPRESSION FILLING (riverFlowToOcean) ---
+// Receivers follow 'surface': the heightmap with every depression filled to
+// its spill level, plus a per-cell epsilon over each flat so it drains
+// towards its outlet. Refilled lazily after terrain edits.
+static const int FILL_TILE = 128;
+static const int OUTLET = 0; // Watershed label of the sea and the map edge
+static std::vector<float> surface, nextSurface;
+static std::vector<int> fillLabel;
+static std::vector<uint8_t> flatCell;
+static bool fillDirty = true;
+
+static std::vector<float> outflow;
+static std::vector<std::vector<int>> carvedCells; // Per Update chunk
+
+// --- FLOW ORDER (SolveFlow) ---
+static const int ORDER_BUCKETS = 1 << 14;
+static const int ORDER_ROWS = 64; // Rows per histogram chunk
+static std::vector<uint64_t> order; // Draining cells, see SortByHeight
+static std::vector<int> bucketCounts, bucketStart;
+static std::vector<int> basin; // Sink cell each cell drains to
+
+// Lowest neighbour on 'level' (the heightmap or the filled surface)
+static int LowestNeighbour(const float *height, const float *level,
+                           const NeighborGraph &g, float seaLevel, int i) {
+  int lowestN = -1;
+  // Oceans are sinks: they take water in but never pass it on
+  if (height[i] >= seaLevel) {
+    float minH = level[i];
+    const int *n = g.neighborData + g.offsetTable[i];
+    for (int k = 0; k < g.countTable[i]; ++k) {
+      if (level[n[k]] < minH) {
+        minH = level[n[k]];
+        lowestN = n[k];
+      }
+    }
+  }
+  return lowestN;
+}
+
+// Float 'ulps' representable steps above f
+static float Nudge(float f, uint32_t ulps) {
+  uint32_t u;
+  std::memcpy(&u, &f, sizeof(u));
+  u = (u & 0x80000000u) ? ~u : (u | 0x80000000u); // Ascending as uint
+  u += ulps;
+  u = (u & 0x80000000u) ? (u & 0x7FFFFFFFu) : ~u;
+  std::memcpy(&f, &u, sizeof(f));
+  return f;
+}
+
+struct SpillEdge {
+  int a, b;    // Watershed labels
+  float level; // Lowest known pass between them
+};
+
+// Tiled Priority-Flood (Barnes et al. 2016). Each tile floods inwards from
+// its own perimeter, the sea and the map edge; every perimeter cell starts
+// a watershed and the passes between watersheds become spill edges. A
+// minimax flood over that small graph, seeded from OUTLET, gives each
+// watershed its global water level. Flats then get their epsilon slope by
+// BFS distance from their outlets, the same drainage Priority-Flood+e
+// produces. Returns the new surface in nextSurface and labels lakes.
+static void FillDepressions(WorldBuffers &b, const NeighborGraph &g,
+                            float seaLevel, int side) {
+  const float *height = b.height;
+  int tiles = (side + FILL_TILE - 1) / FILL_TILE;
+  int labelsPerTile = 4 * FILL_TILE;
+  nextSurface.resize(b.count);
+  fillLabel.resize(b.count);
+  float *level = nextSurface.data();
+  int *label = fillLabel.data();
+  const int *nbr = g.neighborData;
+  const int *nbrOffset = g.offsetTable;
+  const uint8_t *nbrCount = g.countTable;
+  auto tileOf = [&](int i) {
+    return ((i / side) / FILL_TILE) * tiles + (i % side) / FILL_TILE;
+  };
+
+  // --- 1. LOCAL FLOOD PER TILE ---
+  // Cells a pop fills up to its own level skip the heap and go through a
+  // plain FIFO ('pit' queue) instead
+  std::vector<std::vector<SpillEdge>> edges(tiles * tiles);
+  ThreadPool::ParallelFor(0, tiles * tiles, 1, [&](int lo, int hi) {
+    typedef std::pair<float, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    std::vector<int> pit;
+    for (int t = lo; t < hi; ++t) {
+      int x0 = (t % tiles) * FILL_TILE, y0 = (t / tiles) * FILL_TILE;
+      int x1 = std::min(side, x0 + FILL_TILE), y1 = std::min(side, y0 + FILL_TILE);
+      int nextLabel = 1 + t * labelsPerTile;
+      std::vector<SpillEdge> &spill = edges[t];
+      for (int y = y0; y < y1; ++y)
+        for (int x = x0; x < x1; ++x) {
+          int i = y * side + x;
+          level[i] = height[i];
+          bool edge = x == 0 || y == 0 || x == side - 1 || y == side - 1;
+          bool rim = x == x0 || y == y0 || x == x1 - 1 || y == y1 - 1;
+          if (height[i] < seaLevel) {
+            label[i] = OUTLET; // Never raised: only coasts need flooding from
+          } else if (edge) {
+            label[i] = OUTLET;
+            open.push({level[i], i});
+          } else if (rim) {
+            label[i] = -2; // Own watershed, numbered when popped
+            open.push({level[i], i});
+          } else {
+            label[i] = -1; // Not reached yet
+          }
+        }
+      // Land on the coast drains straight into the sea
+      for (int y = y0; y < y1; ++y)
+        for (int x = x0; x < x1; ++x) {
+          int i = y * side + x;
+          if (label[i] != -1)
+            continue;
+          const int *n = nbr + nbrOffset[i];
+          for (int k = 0; k < nbrCount[i]; ++k)
+            if (height[n[k]] < seaLevel) {
+              label[i] = OUTLET;
+              open.push({level[i], i});
+              break;
+            }
+        }
+      size_t pitHead = 0;
+      pit.clear();
+      while (pitHead < pit.size() || !open.empty()) {
+        int c;
+        if (pitHead < pit.size()) {
+          c = pit[pitHead++];
+        } else {
+          c = open.top().second;
+          open.pop();
+          pitHead = 0;
+          pit.clear();
+        }
+        if (label[c] == -2)
+          label[c] = nextLabel++;
+        const int *n = nbr + nbrOffset[c];
+        for (int k = 0; k < nbrCount[c]; ++k) {
+          int j = n[k];
+          int jx = j % side, jy = j / side;
+          if (jx < x0 || jx >= x1 || jy < y0 || jy >= y1)
+            continue;
+          if (label[j] == -1) {
+            label[j] = label[c];
+            if (height[j] <= level[c]) {
+              level[j] = level[c];
+              pit.push_back(j);
+            } else {
+              open.push({level[j], j});
+            }
+          } else if (label[j] >= 0 && label[j] != label[c]) {
+            spill.push_back({label[c], label[j], std::max(level[c], level[j])});
+          }
+        }
+      }
+    }
+  });
+
+  // --- 2. PASSES ACROSS TILE BORDERS ---
+  // Only rim cells have neighbours in another tile, and nothing fills them
+  ThreadPool::ParallelFor(0, tiles * tiles, 1, [&](int lo, int hi) {
+    for (int t = lo; t < hi; ++t) {
+      int x0 = (t % tiles) * FILL_TILE, y0 = (t / tiles) * FILL_TILE;
+      int x1 = std::min(side, x0 + FILL_TILE), y1 = std::min(side, y0 + FILL_TILE);
+      for (int y = y0; y < y1; ++y)
+        for (int x = x0; x < x1; ++x) {
+          if (x != x0 && y != y0 && x != x1 - 1 && y != y1 - 1)
+            continue;
+          int i = y * side + x;
+          const int *n = nbr + nbrOffset[i];
+          for (int k = 0; k < nbrCount[i]; ++k) {
+            int j = n[k];
+            if (j > i && tileOf(j) != t && label[j] != label[i])
+              edges[t].push_back(
+                  {label[i], label[j], std::max(height[i], height[j])});
+          }
+        }
+    }
+  });
+
+  // --- 3. GLOBAL WATER LEVELS ---
+  int labels = 1 + tiles * tiles * labelsPerTile;
+  std::vector<int> degree(labels + 1, 0);
+  for (const auto &list : edges)
+    for (const SpillEdge &e : list) {
+      degree[e.a + 1]++;
+      degree[e.b + 1]++;
+    }
+  for (int l = 0; l < labels; ++l)
+    degree[l + 1] += degree[l];
+  std::vector<std::pair<int, float>> adj(degree[labels]);
+  std::vector<int> fillPos(degree.begin(), degree.end() - 1);
+  for (const auto &list : edges)
+    for (const SpillEdge &e : list) {
+      adj[fillPos[e.a]++] = {e.b, e.level};
+      adj[fillPos[e.b]++] = {e.a, e.level};
+    }
+  std::vector<float> waterLevel(labels, HUGE_VALF);
+  {
+    typedef std::pair<float, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    waterLevel[OUTLET] = -HUGE_VALF;
+    open.push({-HUGE_VALF, OUTLET});
+    while (!open.empty()) {
+      Entry top = open.top();
+      open.pop();
+      int u = top.second;
+      if (top.first > waterLevel[u])
+        continue;
+      for (int k = degree[u]; k < degree[u + 1]; ++k) {
+        float w = std::max(top.first, adj[k].second);
+        int v = adj[k].first;
+        if (w < waterLevel[v]) {
+          waterLevel[v] = w;
+          open.push({w, v});
+        }
+      }
+    }
+  }
+  ThreadPool::ParallelFor(0, side, 16, [&](int rowLo, int rowHi) {
+    for (int i = rowLo * side; i < rowHi * side; ++i)
+      level[i] = std::max(level[i], waterLevel[label[i]]);
+  });
+
+  // --- 4. LAKES ---
+  // Connected cells the fill raised above the terrain
+  int *lakeID = b.lakeID;
+  std::vector<int> queue;
+  if (lakeID) {
+    std::fill_n(lakeID, b.count, 0);
+    int lakes = 0;
+    for (int i = 0; i < side * side; ++i) {
+      if (lakeID[i] || level[i] <= height[i])
+        continue;
+      lakeID[i] = ++lakes;
+      queue.assign(1, i);
+      for (size_t q = 0; q < queue.size(); ++q) {
+        const int *n = nbr + nbrOffset[queue[q]];
+        for (int k = 0; k < nbrCount[queue[q]]; ++k) {
+          int j = n[k];
+          if (!lakeID[j] && level[j] > height[j]) {
+            lakeID[j] = lakes;
+            queue.push_back(j);
+          }
+        }
+      }
+    }
+  }
+
+  // --- 5. EPSILON OVER FLATS ---
+  // A flat cell is land with no lower neighbour. BFS outwards from the
+  // cells that do drain; each step adds one float step, so every flat cell
+  // ends up just above the neighbour it was reached from.
+  std::vector<uint8_t> &flat = flatCell;
+  flat.assign(b.count, 0);
+  ThreadPool::ParallelFor(0, side, 16, [&](int rowLo, int rowHi) {
+    for (int y = rowLo; y < rowHi; ++y)
+      for (int x = 0; x < side; ++x) {
+        int i = y * side + x;
+        bool edge = x == 0 || y == 0 || x == side - 1 || y == side - 1;
+        flat[i] = !edge &&
+                  LowestNeighbour(height, level, g, seaLevel, i) == -1 &&
+                  height[i] >= seaLevel;
+      }
+  });
+  std::vector<int> &steps = fillLabel; // Labels are spent by now
+  std::fill(steps.begin(), steps.end(), 0);
+  queue.clear();
+  for (int i = 0; i < side * side; ++i) {
+    if (!flat[i])
+      continue;
+    const int *n = nbr + nbrOffset[i];
+    for (int k = 0; k < nbrCount[i]; ++k) {
+      int j = n[k];
+      if (!flat[j] && level[j] == level[i]) {
+        steps[i] = 1;
+        queue.push_back(i);
+        break;
+      }
+    }
+  }
+  for (size_t q = 0; q < queue.size(); ++q) {
+    int c = queue[q];
+    const int *n = nbr + nbrOffset[c];
+    for (int k = 0; k < nbrCount[c]; ++k) {
+      int j = n[k];
+      if (flat[j] && !steps[j] && level[j] == level[c]) {
+        steps[j] = steps[c] + 1;
+        queue.push_back(j);
+      }
+    }
+  }
+  for (int c : queue)
+    level[c] = Nudge(level[c], (uint32_t)steps[c]);
+}
+
+// Surface receivers follow: filled when rivers are forced to the sea
+static const float *RoutingLevel(const WorldBuffers &b, const WorldSettings &s) {
+  return s.riverFlowToOcean ? surface.data() : b.height;
+}
+
+// Brings the receiver cache (and the filled surface) up to date with b.height
+static void Route(WorldBuffers &b, const NeighborGraph &g,
+                  const WorldSettings &s, int side) {
+  float seaLevel = s.seaLevel;
+  bool filled = s.riverFlowToOcean;
+  if (routedHeight != b.height || routedCount != b.count ||
+      routedSeaLevel != seaLevel || routedFilled != filled ||
+      receiver.size() != b.count) {
+    receiver.assign(b.count, -1);
+    tilesX = (side + (1 << FLOW_TILE_SHIFT) - 1) >> FLOW_TILE_SHIFT;
+    tileDirty.assign((size_t)tilesX * tilesX, 1);
+    routedHeight = b.height;
+    routedCount = b.count;
+    routedSeaLevel = seaLevel;
+    routedFilled = filled;
+    surface.clear();
+    if (b.lakeID)
+      std::fill_n(b.lakeID, b.count, 0);
+    allDirty = true;
+    fillDirty = true;
+  }
+  if (allDirty)
+    std::fill(tileDirty.begin(), tileDirty.end(), 1);
 
-    // ADD 'const WorldSettings& s' here to match the header and main.cpp
-    void Update(WorldBuffers& b, const NeighborGraph& g, const WorldSettings& s) {
-        if (!b.height || !b.moisture) return;
-
-        // Use settings for logic
-        float seaLevel = s.seaLevel; 
-
-        for (int i = 0; i < b.count; ++i) {
-            // Skip Ocean logic for hydrology flow
-            if (b.height[i] < seaLevel) continue;
-
-            // 1. Simple Moisture Runoff
-            // Look for lower neighbor
-            int lowestN = -1;
-            float minH = b.height[i];
-            
-            int offset = g.offsetTable[i];
-            int count = g.countTable[i];
-
-            for (int k = 0; k < count; ++k) {
-                int nIdx = g.neighborData[offset + k];
-                if (b.height[nIdx] < minH) {
-                    minH = b.height[nIdx];
-                    lowestN = nIdx;
-                }
+  const int T = 1 << FLOW_TILE_SHIFT;
+  if (filled && fillDirty) {
+    FillDepressions(b, g, seaLevel, side);
+    // Filling reaches far beyond the edit: re-route wherever the surface moved
+    if (surface.size() != b.count) {
+      std::fill(tileDirty.begin(), tileDirty.end(), 1);
+    } else {
+      ThreadPool::ParallelFor(0, tilesX, 1, [&](int tyLo, int tyHi) {
+        for (int ty = tyLo; ty < tyHi; ++ty)
+          for (int tx = 0; tx < tilesX; ++tx) {
+            uint8_t &dirty = tileDirty[ty * tilesX + tx];
+            int y1 = std::min(side, (ty + 1) * T);
+            int x1 = std::min(side, (tx + 1) * T);
+            for (int y = ty * T; y < y1 && !dirty; ++y) {
+              size_t row = (size_t)y * side + tx * T;
+              dirty = std::memcmp(&surface[row], &nextSurface[row],
+                                  (x1 - tx * T) * sizeof(float)) != 0;
             }
+          }
+      });
+    }
+    surface.swap(nextSurface);
+    fillDirty = false;
+  }
+  const float *level = RoutingLevel(b, s);
+
+  // A changed cell moves its neighbours' receivers too: grow by one tile
+  tileScratch.assign(tileDirty.size(), 0);
+  bool any = false;
+  for (int ty = 0; ty < tilesX; ++ty)
+    for (int tx = 0; tx < tilesX; ++tx) {
+      if (!tileDirty[ty * tilesX + tx])
+        continue;
+      any = true;
+      for (int ny = std::max(0, ty - 1); ny <= std::min(tilesX - 1, ty + 1); ++ny)
+        for (int nx = std::max(0, tx - 1); nx <= std::min(tilesX - 1, tx + 1);
+             ++nx)
+          tileScratch[ny * tilesX + nx] = 1;
+    }
+  if (!any)
+    return;
+
+  ThreadPool::ParallelFor(0, tilesX, 1, [&](int tyLo, int tyHi) {
+    for (int ty = tyLo; ty < tyHi; ++ty)
+      for (int tx = 0; tx < tilesX; ++tx) {
+        if (!tileScratch[ty * tilesX + tx])
+          continue;
+        int y1 = std::min(side, (ty + 1) * T), x1 = std::min(side, (tx + 1) * T);
+        for (int y = ty * T; y < y1; ++y)
+          for (int i = y * side + tx * T; i < y * side + x1; ++i)
+            receiver[i] = LowestNeighbour(b.height, level, g, seaLevel, i);
+      }
+  });
+  std::fill(tileDirty.begin(), tileDirty.end(), 0);
+  allDirty = false;
+}
+
+void MarkTerrainDirty(int x0, int y0, int x1, int y1) {
+  if (tileDirty.empty() || x0 >= x1 || y0 >= y1)
+    return;
+  int side = tilesX << FLOW_TILE_SHIFT;
+  int tx0 = clamp_val(x0, 0, side - 1) >> FLOW_TILE_SHIFT;
+  int ty0 = clamp_val(y0, 0, side - 1) >> FLOW_TILE_SHIFT;
+  int tx1 = clamp_val(x1 - 1, 0, side - 1) >> FLOW_TILE_SHIFT;
+  int ty1 = clamp_val(y1 - 1, 0, side - 1) >> FLOW_TILE_SHIFT;
+  for (int ty = ty0; ty <= ty1; ++ty)
+    for (int tx = tx0; tx <= tx1; ++tx)
+      tileDirty[ty * tilesX + tx] = 1;
+  fillDirty = true;
+}
 
-            // Move water downhill
-            if (lowestN != -1) {
-                float flow = b.moisture[i] * 0.1f; // 10% flow per tick
-                b.moisture[i] -= flow;
-                b.moisture[lowestN] += flow;
-                
-                // Erosion effect (water carving rivers)
-                if (flow > 0.05f) {
-                    b.height[i] -= 0.001f;
-                    b.height[lowestN] += 0.001f; // Deposit sediment
-                }
+void MarkTerrainDirty() {
+  allDirty = true;
+  fillDirty = true;
+}
+
+// Each phase is a gather over row bands: cells only write themselves, and
+// inflow is summed in neighbour-list order, so the result does not depend
+// on the thread count
+void Update(WorldBuffers &b, const NeighborGraph &g, const WorldSettings &s) {
+  if (!b.height || !b.moisture || !g.neighborData)
+    return;
+  int side = (int)std::sqrt(b.count);
+  if (side == 0)
+    return;
+
+  // --- 1. DOWNHILL CHOICE ---
+  Route(b, g, s, side);
+  float *level = s.riverFlowToOcean ? surface.data() : nullptr;
+  outflow.resize(b.count);
+  const int *nbr = g.neighborData;
+  const int *nbrOffset = g.offsetTable;
+  const uint8_t *nbrCount = g.countTable;
+  const int ROW_GRAIN = 16;
+  ThreadPool::ParallelFor(0, side, ROW_GRAIN, [&](int rowLo, int rowHi) {
+    for (int i = rowLo * side; i < rowHi * side; ++i)
+      outflow[i] = (receiver[i] != -1) ? b.moisture[i] * RUNOFF_RATE : 0.0f;
+  });
+
+  // --- 2. GATHER INFLOW ---
+  // Moisture and sediment are updated in place (nothing reads them after
+  // phase 1); flux is routed one hop per tick into the write buffer.
+  const float *flux = b.flux;
+  float *nextFlux = b.nextFlux;
+  carvedCells.resize((side + ROW_GRAIN - 1) / ROW_GRAIN);
+  ThreadPool::ParallelFor(0, side, ROW_GRAIN, [&](int rowLo, int rowHi) {
+    std::vector<int> &carvedHere = carvedCells[rowLo / ROW_GRAIN];
+    carvedHere.clear();
+    for (int i = rowLo * side; i < rowHi * side; ++i) {
+      float inflow = 0.0f, upstreamFlux = 0.0f;
+      int carving = 0;
+      const int *n = nbr + nbrOffset[i];
+      for (int k = 0; k < nbrCount[i]; ++k) {
+        int j = n[k];
+        if (receiver[j] != i)
+          continue;
+        inflow += outflow[j];
+        carving += outflow[j] > EROSION_FLOW;
+        if (flux)
+          upstreamFlux += flux[j];
+      }
+      float out = outflow[i];
+      b.moisture[i] += inflow - out;
+
+      // Erosion effect (water carving rivers, sediment settles downhill)
+      int carved = carving - (out > EROSION_FLOW ? 1 : 0);
+      if (carved != 0) {
+        float hOld = b.height[i];
+        b.height[i] += EROSION_DEPTH * (float)carved;
+        carvedHere.push_back(i);
+        // Lakes stay filled to their spill level; carving is too small to
+        // be worth a refill, so the surface just follows dry cells
+        if (level)
+          level[i] = (level[i] > hOld) ? std::max(level[i], b.height[i])
+                                       : b.height[i];
+      }
+
+      if (nextFlux)
+        nextFlux[i] = out + FLUX_CARRY * upstreamFlux;
+    }
+  });
+  if (b.flux && b.nextFlux)
+    std::swap(b.flux, b.nextFlux);
+
+  // Carving only touches a few cells: re-route them and their neighbours
+  // now rather than dirtying whole tiles, and flag only their pyramid tiles
+  const float *routing = RoutingLevel(b, s);
+  for (const auto &list : carvedCells)
+    for (int i : list) {
+      int x = i % side, y = i / side;
+      LayerPyramid::MarkDirty(LayerPyramid::LAYER_HEIGHT, x, y, x + 1, y + 1);
+      receiver[i] = LowestNeighbour(b.height, routing, g, s.seaLevel, i);
+      const int *n = nbr + nbrOffset[i];
+      for (int k = 0; k < nbrCount[i]; ++k)
+        receiver[n[k]] =
+            LowestNeighbour(b.height, routing, g, s.seaLevel, n[k]);
+    }
+
+  LayerPyramid::MarkLayerDirty(LayerPyramid::LAYER_MOISTURE);
+}
+
+// --- FLOW ORDER ---
+// Cells that drain somewhere, by descending height, so every cell comes
+// before its receiver (sinks pass nothing on and are left out). Parallel
+// counting sort on quantized height (per-chunk histograms give each chunk
+// its own scatter range), then each bucket is sorted exactly. Entries are
+// (descending height, cell) packed into one key so the bucket sorts stay
+// contiguous; the low 32 bits are the cell.
+static uint64_t OrderKey(float h, int cell) {
+  uint32_t u;
+  std::memcpy(&u, &h, sizeof(u));
+  u ^= (u & 0x80000000u) ? 0xFFFFFFFFu : 0x80000000u; // Ascending as uint
+  return ((uint64_t)~u << 32) | (uint32_t)cell;
+}
+
+static void SortByHeight(const float *height, int side) {
+  int chunks = (side + ORDER_ROWS - 1) / ORDER_ROWS;
+  std::vector<float> chunkMin(chunks), chunkMax(chunks);
+  ThreadPool::ParallelFor(0, side, ORDER_ROWS, [&](int rowLo, int rowHi) {
+    float lo = HUGE_VALF, hi = -HUGE_VALF;
+    for (int i = rowLo * side; i < rowHi * side; ++i) {
+      if (receiver[i] == -1)
+        continue;
+      lo = std::min(lo, height[i]);
+      hi = std::max(hi, height[i]);
+    }
+    chunkMin[rowLo / ORDER_ROWS] = lo;
+    chunkMax[rowLo / ORDER_ROWS] = hi;
+  });
+  float minH = *std::min_element(chunkMin.begin(), chunkMin.end());
+  float maxH = *std::max_element(chunkMax.begin(), chunkMax.end());
+  if (minH > maxH)
+    minH = maxH = 0.0f; // Nothing drains
+  float scale = (float)ORDER_BUCKETS / std::max(1e-6f, maxH - minH);
+  auto bucketOf = [&](float h) {
+    return std::min(ORDER_BUCKETS - 1, (int)((maxH - h) * scale));
+  };
+
+  bucketCounts.assign((size_t)chunks * ORDER_BUCKETS, 0);
+  ThreadPool::ParallelFor(0, side, ORDER_ROWS, [&](int rowLo, int rowHi) {
+    int *count = &bucketCounts[(size_t)(rowLo / ORDER_ROWS) * ORDER_BUCKETS];
+    for (int i = rowLo * side; i < rowHi * side; ++i)
+      if (receiver[i] != -1)
+        count[bucketOf(height[i])]++;
+  });
+
+  // Bucket-major, chunk-minor offsets keep the scatter stable
+  bucketStart.assign(ORDER_BUCKETS + 1, 0);
+  int running = 0;
+  for (int k = 0; k < ORDER_BUCKETS; ++k) {
+    bucketStart[k] = running;
+    for (int c = 0; c < chunks; ++c) {
+      int &slot = bucketCounts[(size_t)c * ORDER_BUCKETS + k];
+      int n = slot;
+      slot = running;
+      running += n;
+    }
+  }
+  bucketStart[ORDER_BUCKETS] = running;
+
+  order.resize(running);
+  ThreadPool::ParallelFor(0, side, ORDER_ROWS, [&](int rowLo, int rowHi) {
+    int *next = &bucketCounts[(size_t)(rowLo / ORDER_ROWS) * ORDER_BUCKETS];
+    for (int i = rowLo * side; i < rowHi * side; ++i)
+      if (receiver[i] != -1)
+        order[next[bucketOf(height[i])]++] = OrderKey(height[i], i);
+  });
+
+  ThreadPool::ParallelFor(0, ORDER_BUCKETS, 256, [&](int lo, int hi) {
+    for (int k = lo; k < hi; ++k)
+      std::sort(order.begin() + bucketStart[k],
+                order.begin() + bucketStart[k + 1]);
+  });
+}
+
+void SolveFlow(WorldBuffers &b, const NeighborGraph &g,
+               const WorldSettings &s) {
+  if (!b.height || !b.moisture || !b.flux || !g.neighborData)
+    return;
+  int side = (int)std::sqrt(b.count);
+  if (side == 0)
+    return;
+
+  Route(b, g, s, side);
+  SortByHeight(RoutingLevel(b, s), side);
+
+  // --- ACCUMULATION ---
+  // Fixed point of Update's flux recurrence for the current moisture:
+  // local runoff plus FLUX_CARRY of everything arriving from upstream
+  float *flux = b.flux;
+  ThreadPool::ParallelFor(0, side, ORDER_ROWS, [&](int rowLo, int rowHi) {
+    for (int i = rowLo * side; i < rowHi * side; ++i)
+      flux[i] = (receiver[i] != -1) ? b.moisture[i] * RUNOFF_RATE : 0.0f;
+  });
+  for (uint64_t key : order) {
+    int i = (int)(uint32_t)key;
+    flux[receiver[i]] += FLUX_CARRY * flux[i];
+  }
+  if (b.nextFlux)
+    std::copy(flux, flux + b.count, b.nextFlux);
+
+  // --- BASINS ---
+  // Receivers come later in the order, so walking it backwards labels each
+  // cell after the cell it drains into
+  basin.resize(b.count);
+  ThreadPool::ParallelFor(0, side, ORDER_ROWS, [&](int rowLo, int rowHi) {
+    for (int i = rowLo * side; i < rowHi * side; ++i)
+      basin[i] = i;
+  });
+  for (auto it = order.rbegin(); it != order.rend(); ++it) {
+    int i = (int)(uint32_t)*it;
+    basin[i] = basin[receiver[i]];
+  }
+}
+
+const std::vector<int> &Basins() { return basin; }
+
+const std::vector<int> &Receivers() { return receiver; }
+
+// --- RIVER NETWORK ---
+static const uint8_t NOT_CHANNEL = 255;
+static RiverNetwork rivers;
+static std::vector<uint8_t> channelInflow; // Channel cells draining in
+static std::vector<std::vector<int>> chunkStarts;
+
+RiverNetwork &Rivers() { return rivers; }
+
+void ExtractRivers(const WorldBuffers &b, const WorldSettings &s) {
+  rivers.segments.clear();
+  rivers.cells.clear();
+  if (!b.height || !b.flux || receiver.size() != b.count)
+    return;
+  int side = (int)std::sqrt(b.count);
+  if (side == 0)
+    return;
+  const float *flux = b.flux;
+  const float *height = b.height;
+  float minFlux = s.riverMinFlux, seaLevel = s.seaLevel;
+  auto isChannel = [&](int i) {
+    return flux[i] >= minFlux && height[i] >= seaLevel;
+  };
+
+  // --- 1. CHANNEL CELLS ---
+  // A segment starts wherever a channel does not have exactly one channel
+  // draining into it: at heads and at confluences
+  const int ROW_GRAIN = 16;
+  int chunks = (side + ROW_GRAIN - 1) / ROW_GRAIN;
+  channelInflow.resize(b.count);
+  chunkStarts.resize(chunks);
+  ThreadPool::ParallelFor(0, side, ROW_GRAIN, [&](int rowLo, int rowHi) {
+    for (int y = rowLo; y < rowHi; ++y)
+      for (int x = 0; x < side; ++x) {
+        int i = y * side + x;
+        if (!isChannel(i)) {
+          channelInflow[i] = NOT_CHANNEL;
+          continue;
+        }
+        int inflow = 0;
+        for (int dy = -1; dy <= 1; ++dy)
+          for (int dx = -1; dx <= 1; ++dx) {
+            int nx = x + dx, ny = y + dy;
+            if ((dx || dy) && nx >= 0 && ny >= 0 && nx < side && ny < side) {
+              int j = ny * side + nx;
+              inflow += receiver[j] == i && isChannel(j);
             }
+          }
+        channelInflow[i] = (uint8_t)inflow;
+      }
+  });
+  ThreadPool::ParallelFor(0, side, ROW_GRAIN, [&](int rowLo, int rowHi) {
+    std::vector<int> &starts = chunkStarts[rowLo / ROW_GRAIN];
+    starts.clear();
+    for (int i = rowLo * side; i < rowHi * side; ++i)
+      if (channelInflow[i] != NOT_CHANNEL && channelInflow[i] != 1)
+        starts.push_back(i);
+  });
+  std::vector<int> startCell;
+  for (const auto &list : chunkStarts)
+    startCell.insert(startCell.end(), list.begin(), list.end());
+  int count = (int)startCell.size();
+
+  // --- 2. TRACE ---
+  // Segments are independent walks down the receivers; each band of start
+  // cells traces into its own cell list, spliced together in order
+  const int START_GRAIN = 256;
+  std::vector<std::vector<uint32_t>> chunkCells((count + START_GRAIN - 1) /
+                                                START_GRAIN);
+  std::vector<int> endCell(count);
+  rivers.segments.resize(count);
+  ThreadPool::ParallelFor(0, count, START_GRAIN, [&](int lo, int hi) {
+    std::vector<uint32_t> &cells = chunkCells[lo / START_GRAIN];
+    cells.clear();
+    for (int k = lo; k < hi; ++k) {
+      RiverSegment &seg = rivers.segments[k];
+      seg.firstCell = (uint32_t)cells.size();
+      int i = startCell[k];
+      cells.push_back(i);
+      int last = i;
+      for (int r = receiver[i]; r != -1; r = receiver[r]) {
+        if (channelInflow[r] == NOT_CHANNEL) {
+          if (height[r] < seaLevel)
+            cells.push_back(r); // Reaches the sea
+          break;
         }
+        cells.push_back(r);
+        if (channelInflow[r] != 1)
+          break; // Confluence: the next segment starts here
+        last = r;
+      }
+      seg.cellCount = (uint32_t)cells.size() - seg.firstCell;
+      seg.flux = flux[last];
+      endCell[k] = (int)cells.back();
+    }
+  });
+  std::vector<uint32_t> chunkBase(chunkCells.size(), 0);
+  for (size_t c = 0; c < chunkCells.size(); ++c) {
+    chunkBase[c] = (uint32_t)rivers.cells.size();
+    rivers.cells.insert(rivers.cells.end(), chunkCells[c].begin(),
+                        chunkCells[c].end());
+  }
+
+  // --- 3. TOPOLOGY ---
+  std::vector<int> pending(count, 0);
+  for (int k = 0; k < count; ++k) {
+    RiverSegment &seg = rivers.segments[k];
+    seg.firstCell += chunkBase[k / START_GRAIN];
+    auto it = std::lower_bound(startCell.begin(), startCell.end(), endCell[k]);
+    seg.downstream = (it != startCell.end() && *it == endCell[k] &&
+                      endCell[k] != startCell[k])
+                         ? (int)(it - startCell.begin())
+                         : -1;
+    if (seg.downstream != -1)
+      pending[seg.downstream]++;
+  }
+
+  // Strahler order and main-stem source, heads first. A segment's order is
+  // the highest upstream order, plus one when two or more tie for it.
+  std::vector<int> topOrder, maxCount(count, 0);
+  std::vector<float> sourceFlux(count, -1.0f);
+  for (int k = 0; k < count; ++k) {
+    rivers.segments[k].order = 0;
+    rivers.segments[k].source = startCell[k];
+    if (pending[k] == 0)
+      topOrder.push_back(k);
+  }
+  for (size_t q = 0; q < topOrder.size(); ++q) {
+    int k = topOrder[q];
+    RiverSegment &seg = rivers.segments[k];
+    if (seg.order == 0)
+      seg.order = 1;
+    else if (maxCount[k] > 1)
+      seg.order++;
+    int d = seg.downstream;
+    if (d == -1)
+      continue;
+    RiverSegment &down = rivers.segments[d];
+    if (seg.order > down.order) {
+      down.order = seg.order;
+      maxCount[d] = 1;
+    } else if (seg.order == down.order) {
+      maxCount[d]++;
+    }
+    if (seg.flux > sourceFlux[d]) {
+      sourceFlux[d] = seg.flux;
+      down.source = seg.source;
+    }
+    if (--pending[d] == 0)
+      topOrder.push_back(d);
+  }
+
+  // Mouths and basins, mouths first
+  for (auto it = topOrder.rbegin(); it != topOrder.rend(); ++it) {
+    RiverSegment &seg = rivers.segments[*it];
+    if (seg.downstream != -1) {
+      seg.mouth = rivers.segments[seg.downstream].mouth;
+      seg.basin = rivers.segments[seg.downstream].basin;
+      continue;
     }
+    seg.mouth = endCell[*it];
+    int sink = seg.mouth;
+    while (receiver[sink] != -1)
+      sink = receiver[sink];
+    seg.basin = sink;
+  }
+
+  std::cout << "[HYDRO] " << count << " river segments, "
+            << rivers.cells.size() << " cells\n";
+}
+
+// --- WORLD FILE SECTION ---
+static const uint32_t RIVER_MAGIC = 0x52495652; // "RIVR"
+
+void WriteRivers(std::ostream &out) {
+  uint32_t header[3] = {RIVER_MAGIC, (uint32_t)rivers.segments.size(),
+                        (uint32_t)rivers.cells.size()};
+  out.write(reinterpret_cast<const char *>(header), sizeof(header));
+  out.write(reinterpret_cast<const char *>(rivers.segments.data()),
+            header[1] * sizeof(RiverSegment));
+  out.write(reinterpret_cast<const char *>(rivers.cells.data()),
+            header[2] * sizeof(uint32_t));
+}
+
+// Every channel cell sits in one segment, plus the confluence or sea cell
+// each segment ends on, so a map of n cells has at most n segments and 2n
+// segment cells
+static bool ValidRivers(uint32_t mapCells) {
+  int segments = (int)rivers.segments.size();
+  for (uint32_t cell : rivers.cells)
+    if (cell >= mapCells)
+      return false;
+  for (const RiverSegment &seg : rivers.segments) {
+    if (seg.cellCount == 0 ||
+        (uint64_t)seg.firstCell + seg.cellCount > rivers.cells.size() ||
+        seg.downstream < -1 || seg.downstream >= segments || seg.order < 1 ||
+        seg.source < 0 || (uint32_t)seg.source >= mapCells || seg.mouth < 0 ||
+        (uint32_t)seg.mouth >= mapCells || seg.basin < 0 ||
+        (uint32_t)seg.basin >= mapCells || !std::isfinite(seg.flux))
+      return false;
+  }
+  return true;
+}
+
+bool ReadRivers(std::istream &in, uint32_t mapCells) {
+  rivers.segments.clear();
+  rivers.cells.clear();
+  uint32_t header[3] = {0, 0, 0};
+  if (!in.read(reinterpret_cast<char *>(header), sizeof(header)) ||
+      header[0] != RIVER_MAGIC)
+    return false; // Files written before rivers were saved end here
+  if (header[1] > mapCells || header[2] > 2 * (uint64_t)mapCells) {
+    std::cerr << "[ERROR] River network counts out of range (" << header[1]
+              << " segments, " << header[2] << " cells), ignoring it"
+              << std::endl;
+    return false;
+  }
+  rivers.segments.resize(header[1]);
+  rivers.cells.resize(header[2]);
+  in.read(reinterpret_cast<char *>(rivers.segments.data()),
+          header[1] * sizeof(RiverSegment));
+  in.read(reinterpret_cast<char *>(rivers.cells.data()),
+          header[2] * sizeof(uint32_t));
+  if (!in || !ValidRivers(mapCells)) {
+    std::cerr << "[ERROR] Truncated or corrupt river network, ignoring it"
+              << std::endl;
+    rivers.segments.clear();
+    rivers.cells.clear();
+    return false;
+  }
+  return true;
 }
+} // namespace HydrologySim
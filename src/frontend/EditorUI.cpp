@@ -4,7 +4,9 @@
 #include <vector>
 
 // Helper to wrap the ugly ImGui map editing logic
-void DrawRequirementMap(const char *label, std::map<int, float> &dataMap) {
+// Returns true when the map was edited
+bool DrawRequirementMap(const char *label, std::map<int, float> &dataMap) {
+  bool changed = false;
   ImGui::PushID(label); // <--- FIX: Scope IDs to this specific map
   ImGui::Text("%s", label);
 
@@ -28,8 +30,8 @@ void DrawRequirementMap(const char *label, std::map<int, float> &dataMap) {
     ImGui::Text("%s", name.c_str());
     ImGui::SameLine();
     ImGui::SetNextItemWidth(80);
-    ImGui::DragFloat("##amt", &amount, 0.1f, -1.0f,
-                     1.0f); // -1=avoid, 0=neutral, +1=seek
+    changed |= ImGui::DragFloat("##amt", &amount, 0.1f, -1.0f,
+                                1.0f); // -1=avoid, 0=neutral, +1=seek
 
     ImGui::PopID();
   }
@@ -37,6 +39,7 @@ void DrawRequirementMap(const char *label, std::map<int, float> &dataMap) {
   // Remove deleted items
   for (int id : toRemove)
     dataMap.erase(id);
+  changed |= !toRemove.empty();
 
   // 2. ADD NEW
   static int selectedResToAdd = 0;
@@ -61,9 +64,11 @@ void DrawRequirementMap(const char *label, std::map<int, float> &dataMap) {
     if (ImGui::Button("Add")) {
       int realID = AssetManager::resourceRegistry[selectedResToAdd].id;
       dataMap[realID] = 0.0f; // Default neutral
+      changed = true;
     }
   }
   ImGui::PopID(); // <--- FIX: End scope
+  return changed;
 }
 
 void DrawDatabaseEditor(bool *p_open) {
@@ -154,6 +159,7 @@ void DrawDatabaseEditor(bool *p_open) {
       ImGui::BeginChild("AgentDetails");
       if (selectedAg < (int)AssetManager::agentRegistry.size()) {
         AgentDefinition &a = AssetManager::agentRegistry[selectedAg];
+        bool speciesChanged = false; // Recompile the species table
 
         // Name buffer for editing
         static char nameBuf[64];
@@ -166,35 +172,47 @@ void DrawDatabaseEditor(bool *p_open) {
         const char *types[] = {"Flora (Plant)", "Fauna (Animal)",
                                "Civ (Faction)"};
         int typeIdx = (int)a.type;
-        if (ImGui::Combo("Class", &typeIdx, types, 3))
+        if (ImGui::Combo("Class", &typeIdx, types, 3)) {
           a.type = (AgentType)typeIdx;
+          speciesChanged = true;
+        }
 
         ImGui::ColorEdit3("Map Color", a.color);
 
         ImGui::Separator();
         ImGui::Text("Biology - Temperature");
-        ImGui::SliderFloat("Ideal Temp", &a.idealTemp, 0.0f, 1.0f);
-        ImGui::SliderFloat("Deadly Low", &a.deadlyTempLow, 0.0f, 1.0f);
-        ImGui::SliderFloat("Deadly High", &a.deadlyTempHigh, 0.0f, 1.0f);
+        speciesChanged |=
+            ImGui::SliderFloat("Ideal Temp", &a.idealTemp, 0.0f, 1.0f);
+        speciesChanged |=
+            ImGui::SliderFloat("Deadly Low", &a.deadlyTempLow, 0.0f, 1.0f);
+        speciesChanged |=
+            ImGui::SliderFloat("Deadly High", &a.deadlyTempHigh, 0.0f, 1.0f);
 
         ImGui::Separator();
         ImGui::Text("Biology - Moisture");
-        ImGui::SliderFloat("Ideal Moisture", &a.idealMoisture, 0.0f, 1.0f);
-        ImGui::SliderFloat("Dead Dry", &a.deadlyMoistureLow, 0.0f, 1.0f);
-        ImGui::SliderFloat("Dead Wet", &a.deadlyMoistureHigh, 0.0f, 1.0f);
+        speciesChanged |=
+            ImGui::SliderFloat("Ideal Moisture", &a.idealMoisture, 0.0f, 1.0f);
+        speciesChanged |=
+            ImGui::SliderFloat("Dead Dry", &a.deadlyMoistureLow, 0.0f, 1.0f);
+        speciesChanged |=
+            ImGui::SliderFloat("Dead Wet", &a.deadlyMoistureHigh, 0.0f, 1.0f);
 
         ImGui::Separator();
         ImGui::Text("Behavior");
         ImGui::SliderFloat("Resilience", &a.resilience, 0.0f, 1.0f);
-        ImGui::SliderFloat("Aggression", &a.aggression, 0.0f, 1.0f);
-        ImGui::SliderFloat("Expansion Rate", &a.expansionRate, 0.0f, 1.0f);
+        speciesChanged |=
+            ImGui::SliderFloat("Aggression", &a.aggression, 0.0f, 1.0f);
+        speciesChanged |=
+            ImGui::SliderFloat("Expansion Rate", &a.expansionRate, 0.0f, 1.0f);
         ImGui::SliderFloat("Food Need/Tick", &a.foodRequirement, 0.0f, 10.0f);
 
         ImGui::Separator();
         ImGui::Text("Economy");
-        DrawRequirementMap("Consumes (Diet)", a.diet);
+        speciesChanged |= DrawRequirementMap("Consumes (Diet)", a.diet);
         ImGui::Spacing();
-        DrawRequirementMap("Produces (Output)", a.output);
+        speciesChanged |= DrawRequirementMap("Produces (Output)", a.output);
+        if (speciesChanged)
+          AssetManager::CompileSpeciesTable();
       }
       ImGui::EndChild();
 
@@ -2,6 +2,7 @@
 #include "../../include/AssetManager.hpp"
 #include "../../include/Biology.hpp"
 #include "../../include/Environment.hpp"
+#include "../../include/Simulation.hpp"
 #include <algorithm>
 #include <cmath>
 #include <cstdio>
@@ -198,10 +199,11 @@ void GuiController::DrawArchitectPanel(
         if (forceEdges)
           terrain.EnforceOceanEdges(buffers, side, edgeFadeDist);
 
-        for (int i = 0; i < 100; ++i) {
-          HydrologySim::Update(buffers, graph, settings);
+        HydrologySim::SolveFlow(buffers, graph, settings);
+        DisasterSystem::ClearEvents();
+        for (int i = 0; i < 100; ++i)
           DisasterSystem::Update(buffers, settings);
-        }
+        HydrologySim::ExtractRivers(buffers, settings);
 
         requiresRedraw = true; // Full regen always needs redraw
       }
@@ -342,6 +344,7 @@ void GuiController::DrawArchitectPanel(
       if (ImGui::Button("Clear Biology")) {
         std::fill_n(buffers.population, buffers.count, 0);
         std::fill_n(buffers.factionID, buffers.count, 0);
+        FactionStats::Invalidate();
       }
 
       ImGui::SeparatorText("Simulation Control");
@@ -531,6 +534,7 @@ void GuiController::DrawDatabaseEditor(bool *p_open) {
           b.scarcity = 0.0f;
           AssetManager::biomeRegistry.push_back(b);
           selectedBiome = (int)AssetManager::biomeRegistry.size() - 1;
+          AssetManager::CompileBiomeTable();
         }
         ImGui::EndChild();
 
@@ -548,19 +552,24 @@ void GuiController::DrawDatabaseEditor(bool *p_open) {
           }
           ImGui::ColorEdit3("Color", b.color);
           ImGui::SeparatorText("Conditions");
-          ImGui::DragFloatRange2("Height", &b.minHeight, &b.maxHeight, 0.01f,
-                                 -1.0f, 1.0f);
-          ImGui::DragFloatRange2("Temp", &b.minTemp, &b.maxTemp, 0.01f, -1.0f,
-                                 2.0f);
-          ImGui::DragFloatRange2("Moisture", &b.minMoisture, &b.maxMoisture,
-                                 0.01f, 0.0f, 2.0f);
-          ImGui::SliderFloat("Scarcity", &b.scarcity, 0.0f, 1.0f);
+          // Height is relative to sea level: -1 = ocean floor, 1 = peaks
+          bool rulesChanged = false;
+          rulesChanged |= ImGui::DragFloatRange2(
+              "Height", &b.minHeight, &b.maxHeight, 0.01f, -1.0f, 1.0f);
+          rulesChanged |= ImGui::DragFloatRange2("Temp", &b.minTemp, &b.maxTemp,
+                                                 0.01f, -1.0f, 2.0f);
+          rulesChanged |= ImGui::DragFloatRange2(
+              "Moisture", &b.minMoisture, &b.maxMoisture, 0.01f, 0.0f, 2.0f);
+          rulesChanged |= ImGui::SliderFloat("Scarcity", &b.scarcity, 0.0f, 1.0f);
 
           if (ImGui::Button("Delete Biome")) {
             AssetManager::biomeRegistry.erase(
                 AssetManager::biomeRegistry.begin() + selectedBiome);
             selectedBiome = -1;
+            rulesChanged = true;
           }
+          if (rulesChanged)
+            AssetManager::CompileBiomeTable();
           ImGui::EndGroup();
         }
         ImGui::EndTabItem();
@@ -590,6 +599,7 @@ void GuiController::DrawDatabaseEditor(bool *p_open) {
         if (selectedAgent >= 0 &&
             selectedAgent < (int)AssetManager::agentRegistry.size()) {
           AgentDefinition &a = AssetManager::agentRegistry[selectedAgent];
+          bool speciesChanged = false; // Recompile the species table
           ImGui::BeginChild("AgentSettings", ImVec2(0, 0), false);
           char aName[64];
           std::memset(aName, 0, 64);
@@ -599,25 +609,33 @@ void GuiController::DrawDatabaseEditor(bool *p_open) {
 
           const char *types[] = {"Flora", "Fauna", "Civilized"};
           int tIdx = (int)a.type;
-          if (ImGui::Combo("Type", &tIdx, types, 3))
+          if (ImGui::Combo("Type", &tIdx, types, 3)) {
             a.type = (AgentType)tIdx;
+            speciesChanged = true;
+          }
           ImGui::ColorEdit3("Color", a.color);
 
           if (ImGui::BeginTabBar("AgentConfigTabs")) {
             // PAGE 1: BIOLOGY
             if (ImGui::BeginTabItem("Biology")) {
               ImGui::SeparatorText("Tolerances");
-              ImGui::SliderFloat("Ideal Temp", &a.idealTemp, 0, 1);
-              ImGui::SliderFloat("Ideal Moist", &a.idealMoisture, 0, 1);
-              ImGui::DragFloatRange2("Temp Low/High", &a.deadlyTempLow,
-                                     &a.deadlyTempHigh, 0.01f, -1.0f, 2.0f);
-              ImGui::DragFloatRange2("Moist Low/High", &a.deadlyMoistureLow,
-                                     &a.deadlyMoistureHigh, 0.01f, 0.0f, 2.0f);
+              speciesChanged |=
+                  ImGui::SliderFloat("Ideal Temp", &a.idealTemp, 0, 1);
+              speciesChanged |=
+                  ImGui::SliderFloat("Ideal Moist", &a.idealMoisture, 0, 1);
+              speciesChanged |= ImGui::DragFloatRange2(
+                  "Temp Low/High", &a.deadlyTempLow, &a.deadlyTempHigh, 0.01f,
+                  -1.0f, 2.0f);
+              speciesChanged |= ImGui::DragFloatRange2(
+                  "Moist Low/High", &a.deadlyMoistureLow,
+                  &a.deadlyMoistureHigh, 0.01f, 0.0f, 2.0f);
 
               ImGui::SeparatorText("Growth & Combat");
               ImGui::SliderFloat("Resilience", &a.resilience, 0, 1);
-              ImGui::SliderFloat("Expansion", &a.expansionRate, 0, 1);
-              ImGui::SliderFloat("Aggression", &a.aggression, 0, 1);
+              speciesChanged |=
+                  ImGui::SliderFloat("Expansion", &a.expansionRate, 0, 1);
+              speciesChanged |=
+                  ImGui::SliderFloat("Aggression", &a.aggression, 0, 1);
               ImGui::EndTabItem();
             }
 
@@ -646,6 +664,7 @@ void GuiController::DrawDatabaseEditor(bool *p_open) {
               ImGui::SliderFloat("Value (-1 to 1)", &dietVal, -1.0f, 1.0f);
               if (ImGui::Button("Update Affinity/Diet")) {
                 a.diet[dietResID] = dietVal;
+                speciesChanged = true;
               }
 
               ImGui::SeparatorText("Current Rules");
@@ -660,9 +679,10 @@ void GuiController::DrawDatabaseEditor(bool *p_open) {
                 ImGui::Text("%s: %.2f", resName, it->second);
                 ImGui::SameLine(ImGui::GetWindowWidth() - 40);
                 ImGui::PushID(it->first);
-                if (ImGui::SmallButton("X"))
+                if (ImGui::SmallButton("X")) {
                   it = a.diet.erase(it);
-                else
+                  speciesChanged = true;
+                } else
                   ++it;
                 ImGui::PopID();
               }
@@ -690,6 +710,7 @@ void GuiController::DrawDatabaseEditor(bool *p_open) {
               ImGui::SliderFloat("Rate", &outVal, 0.0f, 2.0f);
               if (ImGui::Button("Add Output")) {
                 a.output[outResID] = outVal;
+                speciesChanged = true;
               }
 
               ImGui::SeparatorText("Current Outputs");
@@ -702,9 +723,10 @@ void GuiController::DrawDatabaseEditor(bool *p_open) {
                 ImGui::Text("%s: %.2f", resName, it->second);
                 ImGui::SameLine(ImGui::GetWindowWidth() - 40);
                 ImGui::PushID(it->first + 1000);
-                if (ImGui::SmallButton("X"))
+                if (ImGui::SmallButton("X")) {
                   it = a.output.erase(it);
-                else
+                  speciesChanged = true;
+                } else
                   ++it;
                 ImGui::PopID();
               }
@@ -715,6 +737,8 @@ void GuiController::DrawDatabaseEditor(bool *p_open) {
           }
 
           ImGui::EndChild();
+          if (speciesChanged)
+            AssetManager::CompileSpeciesTable();
         }
         ImGui::EndTabItem();
       }
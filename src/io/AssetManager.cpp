@@ -3,6 +3,8 @@
 #include "../../include/SagaConfig.hpp"
 #include "../../include/SimulationModules.hpp"
 #include "../../include/nlohmann/json.hpp"
+#include <algorithm>
+#include <cmath>
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
@@ -55,7 +57,7 @@ void Initialize() {
                              -1.0f,
                              2.0f,
                              -1.0f,
-                             0.3f,
+                             -0.3f,
                              0.0f});
     biomeRegistry.push_back({1,
                              "Ocean",
@@ -64,8 +66,8 @@ void Initialize() {
                              2.0f,
                              -1.0f,
                              2.0f,
-                             0.3f,
-                             0.5f,
+                             -0.3f,
+                             0.0f,
                              0.0f});
     biomeRegistry.push_back({2,
                              "Beach",
@@ -160,8 +162,8 @@ void Initialize() {
     biomeRegistry.push_back({11,
                              "Tundra",
                              {0.6f, 0.6f, 0.6f},
-                             -0.2f,
-                             0.05f,
+                             0.08f,
+                             0.15f,
                              0.0f,
                              1.0f,
                              0.05f,
@@ -171,7 +173,7 @@ void Initialize() {
                              "Snow",
                              {0.9f, 0.9f, 1.0f},
                              -1.0f,
-                             -0.2f,
+                             0.08f,
                              0.0f,
                              1.0f,
                              0.05f,
@@ -224,6 +226,9 @@ void Initialize() {
   }
 
   SyncWithLore();
+  LoadCalendar();
+  CompileBiomeTable();
+  CompileSpeciesTable();
 
   std::cout << "[ASSETS] Initialized with " << resourceRegistry.size()
             << " resources, " << chaosRules.size() << " chaos rules, "
@@ -392,6 +397,7 @@ void LoadAll(const std::string &path) {
         }
         agentRegistry.push_back(a);
       }
+      CompileSpeciesTable();
     }
 
     if (j.contains("biomes")) {
@@ -414,6 +420,7 @@ void LoadAll(const std::string &path) {
         b.scarcity = item.value("scarcity", 0.0f);
         biomeRegistry.push_back(b);
       }
+      CompileBiomeTable();
     }
 
     std::cout << "[ASSETS] Successfully loaded rules from " << path << "\n";
@@ -514,6 +521,56 @@ ResourceDef *GetResource(int id) {
 
 std::vector<Unit> activeUnits;
 std::map<std::string, float> diplomacyMatrix;
+CalendarDef calendar;
+
+bool LoadCalendar(const std::string &path) {
+  std::ifstream f(path);
+  if (!f.is_open())
+    return false;
+
+  try {
+    json j;
+    f >> j;
+
+    CalendarDef cal;
+    cal.name = j.value("name", cal.name);
+    if (j.contains("monthLens"))
+      cal.monthLengths = j["monthLens"].get<std::vector<int>>();
+    if (j.contains("seasons")) {
+      cal.seasons.clear();
+      for (auto &obj : j["seasons"])
+        cal.seasons.push_back(
+            {obj.value("n", ""), obj.value("m", 1), obj.value("d", 1)});
+    }
+    if (j.contains("moons")) {
+      cal.moons.clear();
+      for (auto &obj : j["moons"])
+        cal.moons.push_back(
+            {obj.value("n", ""), obj.value("c", 28.0f), obj.value("s", 0.0f)});
+    }
+
+    // Seasons must be in calendar order for SeasonAt
+    std::stable_sort(cal.seasons.begin(), cal.seasons.end(),
+                     [&](const CalendarSeason &a, const CalendarSeason &b) {
+                       return a.startMonth < b.startMonth ||
+                              (a.startMonth == b.startMonth &&
+                               a.startDay < b.startDay);
+                     });
+    if (cal.monthLengths.empty() || cal.DaysPerYear() <= 0)
+      return false;
+
+    calendar = cal;
+    std::cout << "[ASSETS] Calendar '" << calendar.name << "': "
+              << calendar.DaysPerYear() << " days, "
+              << calendar.seasons.size() << " seasons, "
+              << calendar.moons.size() << " moons\n";
+    return true;
+  } catch (const std::exception &e) {
+    std::cerr << "[ASSETS] JSON Error during LoadCalendar: " << e.what()
+              << "\n";
+  }
+  return false;
+}
 
 std::string GetDiplomacyKey(int a, int b) {
   if (a > b)
@@ -606,6 +663,7 @@ void CreateNewAgent() {
   a.aggression = 0.0f;
   a.foodRequirement = 1.0f;
   agentRegistry.push_back(a);
+  CompileSpeciesTable();
   std::cout << "[ASSETS] Created new agent: " << a.name << "\n";
 }
 
@@ -701,4 +759,328 @@ float GetTotalCellWealth(uint32_t cellIdx, const WorldBuffers &b) {
   return total;
 }
 
+// --- BIOME TABLE ---
+BiomeTable biomeTable;
+
+// Splits AXIS_RES steps over [lo,hi) at the given edges. Returns the band of
+// every step and one representative value per band. Axes with too many
+// distinct edges fall back to 64 even bands.
+static int BuildAxis(std::vector<float> edges, float lo, float hi,
+                     std::vector<uint8_t> &band, std::vector<float> &centre) {
+  const int R = BiomeTable::AXIS_RES;
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+  edges.erase(std::remove_if(edges.begin(), edges.end(),
+                             [&](float e) { return e <= lo || e >= hi; }),
+              edges.end());
+  if (edges.size() > 63) {
+    edges.clear();
+    for (int k = 1; k < 64; ++k)
+      edges.push_back(lo + (hi - lo) * k / 64.0f);
+  }
+  band.assign(R, 0);
+  std::vector<float> sum(edges.size() + 1, 0.0f);
+  std::vector<int> count(edges.size() + 1, 0);
+  for (int q = 0; q < R; ++q) {
+    float v = lo + (hi - lo) * (q + 0.5f) / R;
+    int k = (int)(std::upper_bound(edges.begin(), edges.end(), v) -
+                  edges.begin());
+    band[q] = (uint8_t)k;
+    sum[k] += v;
+    count[k]++;
+  }
+  centre.assign(edges.size() + 1, 0.0f);
+  for (size_t k = 0; k < centre.size(); ++k)
+    centre[k] = count[k] ? sum[k] / count[k] : lo;
+  return (int)centre.size();
+}
+
+// Margin grid for each height band. A margin step is labelled with its
+// biome, or MIXED when it straddles a boundary; a step's margin is the
+// Chebyshev distance to the nearest differently labelled step (so MIXED
+// steps keep 0).
+static void CompileBiomeMargins(int hBands) {
+  BiomeTable &t = biomeTable;
+  const int G = BiomeTable::MARGIN_RES;
+  const int sub = BiomeTable::AXIS_RES / G;
+  const int MIXED = 256;
+  t.margin.assign((size_t)hBands * G * G, 0);
+
+  // Band range covered by each margin step (bands grow monotonically)
+  std::vector<int> tLo(G), tHi(G), mLo(G), mHi(G);
+  for (int q = 0; q < G; ++q) {
+    tLo[q] = t.tempBand[q * sub];
+    tHi[q] = t.tempBand[q * sub + sub - 1];
+    mLo[q] = t.moistBand[q * sub];
+    mHi[q] = t.moistBand[q * sub + sub - 1];
+  }
+
+  std::vector<int> label(G * G);
+  std::vector<int> dist(G * G);
+  for (int h = 0; h < hBands; ++h) {
+    std::vector<bool> present(MIXED + 1, false);
+    for (int mq = 0; mq < G; ++mq) {
+      for (int tq = 0; tq < G; ++tq) {
+        int l = -1;
+        for (int mb = mLo[mq]; mb <= mHi[mq] && l != MIXED; ++mb)
+          for (int tb = tLo[tq]; tb <= tHi[tq]; ++tb) {
+            int c = t.cells[((size_t)h * t.moistBands + mb) * t.tempBands + tb];
+            if (l >= 0 && l != c) {
+              l = MIXED;
+              break;
+            }
+            l = c;
+          }
+        label[mq * G + tq] = l;
+        present[l] = true;
+      }
+    }
+
+    // Two-pass chessboard distance to the nearest step not labelled L
+    // (the grid border is open: values never leave [0,1])
+    uint8_t *out = &t.margin[(size_t)h * G * G];
+    for (int l = 0; l < MIXED; ++l) {
+      if (!present[l])
+        continue;
+      const int INF = 1 << 20;
+      for (int k = 0; k < G * G; ++k)
+        dist[k] = (label[k] == l) ? INF : 0;
+      for (int y = 0; y < G; ++y)
+        for (int x = 0; x < G; ++x) {
+          int &d = dist[y * G + x];
+          if (x > 0)
+            d = std::min(d, dist[y * G + x - 1] + 1);
+          if (y > 0) {
+            d = std::min(d, dist[(y - 1) * G + x] + 1);
+            if (x > 0)
+              d = std::min(d, dist[(y - 1) * G + x - 1] + 1);
+            if (x < G - 1)
+              d = std::min(d, dist[(y - 1) * G + x + 1] + 1);
+          }
+        }
+      for (int y = G - 1; y >= 0; --y)
+        for (int x = G - 1; x >= 0; --x) {
+          int &d = dist[y * G + x];
+          if (x < G - 1)
+            d = std::min(d, dist[y * G + x + 1] + 1);
+          if (y < G - 1) {
+            d = std::min(d, dist[(y + 1) * G + x] + 1);
+            if (x < G - 1)
+              d = std::min(d, dist[(y + 1) * G + x + 1] + 1);
+            if (x > 0)
+              d = std::min(d, dist[(y + 1) * G + x - 1] + 1);
+          }
+        }
+      for (int k = 0; k < G * G; ++k)
+        if (label[k] == l)
+          out[k] = (uint8_t)std::min(127, dist[k]);
+    }
+  }
+}
+
+void CompileBiomeTable() {
+  BiomeTable &t = biomeTable;
+  t.revision++;
+  int n = std::min((int)biomeRegistry.size(), 256);
+  t.ids.clear();
+  for (int k = 0; k < n; ++k)
+    t.ids.push_back(biomeRegistry[k].id);
+
+  std::vector<float> tEdges, mEdges, hEdges = {0.0f}; // Sea level splits
+  for (int k = 0; k < n; ++k) {
+    const BiomeDef &d = biomeRegistry[k];
+    tEdges.insert(tEdges.end(), {d.minTemp, d.maxTemp});
+    mEdges.insert(mEdges.end(), {d.minMoisture, d.maxMoisture});
+    hEdges.insert(hEdges.end(), {d.minHeight, d.maxHeight});
+  }
+  std::vector<float> tMid, mMid, hMid;
+  t.tempBands = BuildAxis(tEdges, 0.0f, 1.0f, t.tempBand, tMid);
+  t.moistBands = BuildAxis(mEdges, 0.0f, 1.0f, t.moistBand, mMid);
+  int hBands = BuildAxis(hEdges, -1.0f, 1.0f, t.heightBand, hMid);
+  t.cells.assign((size_t)t.tempBands * t.moistBands * hBands, 0);
+  if (n == 0) {
+    t.ids.push_back(0);
+    CompileBiomeMargins(hBands);
+    return;
+  }
+
+  // Candidate order: rarest first, then the smallest range, then file order
+  std::vector<int> order(n);
+  std::vector<float> volume(n);
+  for (int k = 0; k < n; ++k) {
+    const BiomeDef &d = biomeRegistry[k];
+    order[k] = k;
+    volume[k] = std::max(0.0f, d.maxTemp - d.minTemp) *
+                std::max(0.0f, d.maxMoisture - d.minMoisture) *
+                std::max(0.0f, d.maxHeight - d.minHeight);
+  }
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    if (biomeRegistry[a].scarcity != biomeRegistry[b].scarcity)
+      return biomeRegistry[a].scarcity > biomeRegistry[b].scarcity;
+    return volume[a] < volume[b];
+  });
+
+  auto gap = [](float v, float lo, float hi) {
+    return v < lo ? lo - v : (v > hi ? v - hi : 0.0f);
+  };
+  for (int h = 0; h < hBands; ++h) {
+    for (int m = 0; m < t.moistBands; ++m) {
+      for (int c = 0; c < t.tempBands; ++c) {
+        int best = order[0];
+        float bestDist = 1e30f;
+        for (int k : order) {
+          const BiomeDef &d = biomeRegistry[k];
+          // Elevation spans [-1,1], so its distance counts half
+          float dt = gap(tMid[c], d.minTemp, d.maxTemp);
+          float dm = gap(mMid[m], d.minMoisture, d.maxMoisture);
+          float dh = gap(hMid[h], d.minHeight, d.maxHeight) * 0.5f;
+          float dist = dt * dt + dm * dm + dh * dh;
+          if (dist < bestDist) {
+            best = k;
+            bestDist = dist;
+            if (dist == 0.0f)
+              break;
+          }
+        }
+        t.cells[((size_t)h * t.moistBands + m) * t.tempBands + c] =
+            (uint8_t)best;
+      }
+    }
+  }
+  CompileBiomeMargins(hBands);
+}
+
+// --- SPECIES TABLE ---
+SpeciesTable speciesTable;
+
+void CompileSpeciesTable() {
+  SpeciesTable &t = speciesTable;
+  const int R = SpeciesTable::R;
+  int n = (int)agentRegistry.size();
+  t.revision++;
+  t.ids.assign(n, 0);
+  t.flags.assign(n, 0);
+  t.tempLow.assign(n, 0.0f);
+  t.tempHigh.assign(n, 0.0f);
+  t.moistureLow.assign(n, 0.0f);
+  t.moistureHigh.assign(n, 0.0f);
+  t.idealTemp.assign(n, 0.0f);
+  t.idealMoisture.assign(n, 0.0f);
+  t.expansionRate.assign(n, 0.0f);
+  t.aggression.assign(n, 0.0f);
+  t.dietMask.assign(n, 0);
+  t.outputMask.assign(n, 0);
+  t.diet.assign((size_t)n * R, 0.0f);
+  t.output.assign((size_t)n * R, 0.0f);
+
+  int maxID = -1;
+  for (const auto &a : agentRegistry)
+    maxID = std::max(maxID, a.id);
+  t.indexOfID.assign(maxID + 1, SpeciesTable::NONE);
+
+  for (int k = 0; k < n; ++k) {
+    const AgentDefinition &a = agentRegistry[k];
+    t.ids[k] = a.id;
+    if (a.id >= 0 && t.indexOfID[a.id] == SpeciesTable::NONE)
+      t.indexOfID[a.id] = k; // First definition wins on duplicate IDs
+    uint8_t f = 0;
+    if (a.type == AgentType::FLORA)
+      f |= SpeciesTable::FLORA;
+    if (a.type == AgentType::FAUNA)
+      f |= SpeciesTable::FAUNA;
+    if (a.type == AgentType::CIVILIZED)
+      f |= SpeciesTable::CIVILIZED;
+    if (a.isFarmable)
+      f |= SpeciesTable::FARMABLE;
+    if (a.isDomesticatable)
+      f |= SpeciesTable::DOMESTICATABLE;
+    t.flags[k] = f;
+    t.tempLow[k] = a.deadlyTempLow;
+    t.tempHigh[k] = a.deadlyTempHigh;
+    t.moistureLow[k] = a.deadlyMoistureLow;
+    t.moistureHigh[k] = a.deadlyMoistureHigh;
+    t.idealTemp[k] = a.idealTemp;
+    t.idealMoisture[k] = a.idealMoisture;
+    t.expansionRate[k] = a.expansionRate;
+    t.aggression[k] = a.aggression;
+    // Resources past MAX_RESOURCES have no inventory slot and are dropped
+    for (const auto &[res, amount] : a.diet)
+      if (res >= 0 && res < R) {
+        t.dietMask[k] |= 1u << res;
+        t.diet[(size_t)k * R + res] = amount;
+      }
+    for (const auto &[res, amount] : a.output)
+      if (res >= 0 && res < R) {
+        t.outputMask[k] |= 1u << res;
+        t.output[(size_t)k * R + res] = amount;
+      }
+  }
+}
+
+const SpeciesTable &Species() {
+  if (speciesTable.Count() != (int)agentRegistry.size())
+    CompileSpeciesTable();
+  return speciesTable;
+}
+
 } // namespace AssetManager
+
+// --- CALENDAR HELPERS ---
+int CalendarDef::DaysPerYear() const {
+  int days = 0;
+  for (int len : monthLengths)
+    days += len;
+  return days;
+}
+
+int CalendarDef::SeasonStartDay(int season) const {
+  if (season < 0 || season >= (int)seasons.size())
+    return 0;
+  int month = std::min(std::max(seasons[season].startMonth, 1),
+                       (int)monthLengths.size());
+  int day = 0;
+  for (int m = 0; m < month - 1; ++m)
+    day += monthLengths[m];
+  return day + std::max(seasons[season].startDay, 1) - 1;
+}
+
+int CalendarDef::SeasonAt(int day, int *nextSeason, float *blend) const {
+  int n = (int)seasons.size();
+  int year = DaysPerYear();
+  if (n == 0 || year <= 0) {
+    if (nextSeason)
+      *nextSeason = 0;
+    if (blend)
+      *blend = 0.0f;
+    return 0;
+  }
+  day = ((day % year) + year) % year;
+
+  // Last season that started on or before 'day' (wraps to the final season)
+  int cur = n - 1;
+  for (int k = 0; k < n; ++k)
+    if (SeasonStartDay(k) <= day)
+      cur = k;
+  int next = (cur + 1) % n;
+
+  if (nextSeason)
+    *nextSeason = next;
+  if (blend) {
+    int start = SeasonStartDay(cur);
+    int end = SeasonStartDay(next);
+    if (end <= start)
+      end += year;
+    if (day < start)
+      day += year;
+    *blend = (end > start) ? (float)(day - start) / (float)(end - start) : 0.0f;
+  }
+  return cur;
+}
+
+float CalendarDef::MoonPhase(int moon, int day) const {
+  if (moon < 0 || moon >= (int)moons.size() || moons[moon].cycle <= 0.0f)
+    return 0.0f;
+  float p = std::fmod(((float)day - moons[moon].shift) / moons[moon].cycle,
+                      1.0f);
+  return p < 0.0f ? p + 1.0f : p;
+}
@@ -1,12 +1,19 @@
 #include "../../include/BinaryExporter.hpp"
 #include "../../include/WorldEngine.hpp"
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <vector>
 
 namespace BinaryExporter {
 
-void SaveWorld(const WorldBuffers &buffers, const std::string &filename) {
+// World files open with a magic and a format version. Version 0 files (from
+// before the header) start straight with the cell count.
+static const uint32_t WORLD_MAGIC = 0x574F524C; // "WORL"
+static const uint32_t WORLD_VERSION = 1;        // 1: lakeID layer
+
+void SaveWorld(const WorldBuffers &buffers, const std::string &filename,
+               SectionWriter extra) {
   std::ofstream outFile(filename, std::ios::binary);
 
   if (!outFile.is_open()) {
@@ -16,7 +23,8 @@ void SaveWorld(const WorldBuffers &buffers, const std::string &filename) {
 
   // 1. Write Header
   uint32_t count = buffers.count;
-  outFile.write(reinterpret_cast<const char *>(&count), sizeof(uint32_t));
+  uint32_t header[3] = {WORLD_MAGIC, WORLD_VERSION, count};
+  outFile.write(reinterpret_cast<const char *>(header), sizeof(header));
 
   // 2. Dump Layers
   if (buffers.height)
@@ -45,12 +53,19 @@ void SaveWorld(const WorldBuffers &buffers, const std::string &filename) {
   if (buffers.structureType)
     outFile.write(reinterpret_cast<const char *>(buffers.structureType),
                   count * sizeof(uint8_t));
+  if (buffers.lakeID)
+    outFile.write(reinterpret_cast<const char *>(buffers.lakeID),
+                  count * sizeof(int));
+
+  if (extra)
+    extra(outFile);
 
   outFile.close();
   std::cout << "[MAP] Saved world to " << filename << std::endl;
 }
 
-bool LoadWorld(WorldBuffers &buffers, const std::string &filename) {
+bool LoadWorld(WorldBuffers &buffers, const std::string &filename,
+               SectionReader extra) {
   std::ifstream inFile(filename, std::ios::binary);
 
   if (!inFile.is_open()) {
@@ -58,8 +73,18 @@ bool LoadWorld(WorldBuffers &buffers, const std::string &filename) {
   }
 
   // 1. Read Header
-  uint32_t count = 0;
+  uint32_t count = 0, version = 0;
   inFile.read(reinterpret_cast<char *>(&count), sizeof(uint32_t));
+  if (count == WORLD_MAGIC) {
+    inFile.read(reinterpret_cast<char *>(&version), sizeof(uint32_t));
+    inFile.read(reinterpret_cast<char *>(&count), sizeof(uint32_t));
+    if (version > WORLD_VERSION) {
+      std::cerr << "[ERROR] Map format version " << version
+                << " is newer than this build (" << WORLD_VERSION << ")"
+                << std::endl;
+      return false;
+    }
+  }
 
   if (count != buffers.count) {
     std::cerr << "[ERROR] Map cell count mismatch! Expected " << buffers.count
@@ -93,6 +118,17 @@ bool LoadWorld(WorldBuffers &buffers, const std::string &filename) {
   if (buffers.structureType)
     inFile.read(reinterpret_cast<char *>(buffers.structureType),
                 count * sizeof(uint8_t));
+  // Older files carry no lakes; the next depression fill relabels them
+  if (buffers.lakeID) {
+    if (version >= 1)
+      inFile.read(reinterpret_cast<char *>(buffers.lakeID),
+                  count * sizeof(int));
+    else
+      std::fill_n(buffers.lakeID, count, 0);
+  }
+
+  if (extra)
+    extra(inFile, count);
 
   inFile.close();
   std::cout << "[MAP] Loaded world from " << filename << std::endl;
@@ -1,4 +1,5 @@
 #include "../../include/AssetManager.hpp"
+#include "../../include/LayerPyramid.hpp"
 #include "../../include/Lore.hpp"
 #include "../../include/SagaConfig.hpp"
 #include <fstream>
@@ -73,11 +74,16 @@ void ExportGlobalState(const std::string &path, const WorldBuffers &buffers) {
   bool isFamine = false;
   float totalPop = 0;
   float totalWealth = 0.0f;
-  std::map<int, int> factionPower;
+  // Faction power: population of the linked civilized species
+  const SpeciesTable &species = AssetManager::Species();
+  std::vector<int64_t> speciesPop(species.Count(), 0);
 
   for (size_t i = 0; i < buffers.count; ++i) {
     float pop = (float)buffers.population[i];
     totalPop += pop;
+    int k = species.Index(buffers.cultureID[i]);
+    if (k != SpeciesTable::NONE && species.Is(k, SpeciesTable::CIVILIZED))
+      speciesPop[k] += buffers.population[i];
 
     // Hardcoded check for Food (0), Wood (1), Iron (2)
     float cellW = 0.0f;
@@ -103,10 +109,6 @@ void ExportGlobalState(const std::string &path, const WorldBuffers &buffers) {
         (buffers.resourceInventory ? buffers.resourceInventory[i * 16 + 0]
                                    : 0) < 10.0f) // Low Food
       isFamine = true;
-
-    int fid = buffers.factionID[i];
-    if (fid > 0)
-      factionPower[fid] += (int)pop;
   }
 
   std::cout << "[DEBUG] Global State Scan Summary:\n";
@@ -127,7 +129,8 @@ void ExportGlobalState(const std::string &path, const WorldBuffers &buffers) {
       json fObj;
       fObj["id"] = a.id;
       fObj["name"] = a.title;
-      fObj["power"] = factionPower[a.id];
+      int k = species.Index(a.simID);
+      fObj["power"] = k != SpeciesTable::NONE ? speciesPop[k] : 0;
       fObj["year"] = a.formationYear;
       root["factions"].push_back(fObj);
     }
@@ -165,6 +168,34 @@ void ExportGlobalState(const std::string &path, const WorldBuffers &buffers) {
     }
   }
 
+  // 5. Regional Overview (coarse pyramid level, <= 16x16 regions)
+  root["regions"] = json::array();
+  int level = LayerPyramid::Levels() - 1;
+  while (level > 0 && LayerPyramid::Side(level - 1) <= 16)
+    --level;
+  if (level > 0) {
+    int side = LayerPyramid::Side(level);
+    int cellSpan = 1 << level;
+    for (int y = 0; y < side; ++y) {
+      for (int x = 0; x < side; ++x) {
+        json rObj;
+        rObj["x"] = x * cellSpan;
+        rObj["y"] = y * cellSpan;
+        rObj["size"] = cellSpan;
+        rObj["height"] =
+            LayerPyramid::Sample(LayerPyramid::LAYER_HEIGHT, level, x, y);
+        rObj["temperature"] =
+            LayerPyramid::Sample(LayerPyramid::LAYER_TEMPERATURE, level, x, y);
+        rObj["moisture"] =
+            LayerPyramid::Sample(LayerPyramid::LAYER_MOISTURE, level, x, y);
+        rObj["population"] =
+            LayerPyramid::Sample(LayerPyramid::LAYER_POPULATION, level, x, y);
+        rObj["faction"] = LayerPyramid::SampleFaction(level, x, y);
+        root["regions"].push_back(rObj);
+      }
+    }
+  }
+
   std::ofstream out(path);
   out << root.dump(4);
 }
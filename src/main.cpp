@@ -95,7 +95,7 @@ GLuint LoadShaders() {
   return program;
 }
 
-// Hydrology Warm-Up (100 ticks for prominent rivers)
+// Rivers are solved in one pass (no hydrology warm-up ticks)
 void MasterRegenerate(WorldBuffers &buffers, WorldSettings &settings,
                       TerrainController &terrain, NeighborFinder &finder,
                       NeighborGraph &graph) {
@@ -111,15 +111,15 @@ void MasterRegenerate(WorldBuffers &buffers, WorldSettings &settings,
 
   terrain.GenerateProceduralTerrain(buffers, settings);
   finder.BuildGraph(buffers, buffers.count, graph);
+  DisasterSystem::ClearEvents();
 
   if (settings.erosionIterations > 0) {
     terrain.ApplyThermalErosion(buffers, settings.erosionIterations);
   }
 
   if (graph.neighborData) {
-    for (int i = 0; i < 200; ++i) {
-      HydrologySim::Update(buffers, graph, settings);
-    }
+    HydrologySim::SolveFlow(buffers, graph, settings);
+    HydrologySim::ExtractRivers(buffers, settings);
   }
 }
 
@@ -12,21 +12,14 @@ void Update(WorldBuffers &b, const NeighborGraph &g, const WorldSettings &s) {
   const float DEATH_RATE_OLD_AGE = 0.995f;
   const float ACCIDENT_RATE = 0.001f;
 
-  std::vector<int> factionCityPower(AssetManager::agentRegistry.size(), 0);
+  // Factions are indexed by species index in the compiled table; their city
+  // power is the running structure total
+  const SpeciesTable &t = AssetManager::Species();
+  FactionStats::Ensure(b);
 
-  for (uint32_t i = 0; i < b.count; ++i) {
-    int id = b.cultureID[i];
-    if (id != -1 && id < (int)AssetManager::agentRegistry.size()) {
-      const AgentDefinition &def = AssetManager::agentRegistry[id];
-      if (def.type == AgentType::CIVILIZED && b.structureType) {
-        factionCityPower[id] += b.structureType[i];
-      }
-    }
-  }
-
-  std::vector<int> factionTier(AssetManager::agentRegistry.size(), 1);
+  std::vector<int> factionTier(t.Count(), 1);
   for (size_t f = 0; f < factionTier.size(); ++f) {
-    int power = factionCityPower[f];
+    int power = FactionStats::Of((int)f).structures;
     if (power >= 50) factionTier[f] = 6;
     else if (power >= 30) factionTier[f] = 5;
     else if (power >= 15) factionTier[f] = 4;
@@ -35,15 +28,17 @@ void Update(WorldBuffers &b, const NeighborGraph &g, const WorldSettings &s) {
   }
 
   for (uint32_t i = 0; i < b.count; ++i) {
-    int id = b.cultureID[i];
-    if (id == -1 || id >= (int)AssetManager::agentRegistry.size())
+    int k = t.Index(b.cultureID[i]);
+    if (k == SpeciesTable::NONE)
       continue;
 
-    const AgentDefinition &def = AssetManager::agentRegistry[id];
+    bool civilized = t.Is(k, SpeciesTable::CIVILIZED);
+    if (civilized)
+      FactionStats::Leave(b, i);
     float pop = (float)b.population[i];
 
     if (b.civTier) {
-      b.civTier[i] = factionTier[id];
+      b.civTier[i] = factionTier[k];
     }
 
     // Natural Causes
@@ -53,7 +48,7 @@ void Update(WorldBuffers &b, const NeighborGraph &g, const WorldSettings &s) {
     }
 
     // Construction
-    if (def.type == AgentType::CIVILIZED && b.structureType) {
+    if (civilized && b.structureType) {
       uint8_t &structure = b.structureType[i];
 
       if (structure == 0 && pop > 100.0f && b.GetResource(i, 1) > 50.0f) {
@@ -122,6 +117,9 @@ void Update(WorldBuffers &b, const NeighborGraph &g, const WorldSettings &s) {
       }
     }
     b.population[i] = (uint32_t)pop;
+    if (civilized)
+      FactionStats::Enter(b, i);
   }
+  FactionStats::Publish();
 }
 } // namespace CivilizationSim
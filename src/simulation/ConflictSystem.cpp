@@ -14,17 +14,23 @@ void Update(WorldBuffers &b, const NeighborGraph &g, const WorldSettings &s) {
   float banditThreshold = 0.05f;
   float battleDamage = 0.1f;
 
+  const SpeciesTable &t = AssetManager::Species();
   for (uint32_t i = 0; i < b.count; ++i) {
     int myID = b.cultureID[i];
-    if (myID == -1 || myID >= (int)AssetManager::agentRegistry.size())
+    int mk = t.Index(myID);
+    if (mk == SpeciesTable::NONE)
       continue;
 
-    const AgentDefinition &myDef = AssetManager::agentRegistry[myID];
+    bool myCivilized = t.Is(mk, SpeciesTable::CIVILIZED);
+    bool myFauna = t.Is(mk, SpeciesTable::FAUNA);
+    float myAggression = t.aggression[mk];
+    if (myCivilized)
+      FactionStats::Leave(b, i);
     // Cast population to float for checks
     float myStr = (float)b.population[i];
 
     // 1. CRIME
-    if (myDef.type == AgentType::CIVILIZED && b.structureType) {
+    if (myCivilized && b.structureType) {
       float wealth = (b.GetResource(i, 1) + b.GetResource(i, 2));
       float security = (b.structureType[i] * 10.0f) + (myStr * 0.01f);
       if (b.buildingID) {
@@ -51,24 +57,24 @@ void Update(WorldBuffers &b, const NeighborGraph &g, const WorldSettings &s) {
       int nIdx = g.neighborData[offset + k];
       int theirID = b.cultureID[nIdx];
 
-      if (theirID == -1 || theirID == myID ||
-          theirID >= (int)AssetManager::agentRegistry.size())
+      if (theirID == -1 || theirID == myID)
+        continue;
+      int tk = t.Index(theirID);
+      if (tk == SpeciesTable::NONE)
         continue;
 
-      const AgentDefinition &theirDef = AssetManager::agentRegistry[theirID];
       float theirStr = (float)b.population[nIdx];
 
       bool isWar = false;
-      if (myDef.type == AgentType::FAUNA && myDef.aggression > 0.5f)
+      if (myFauna && myAggression > 0.5f)
         isWar = true;
-      if (myDef.type == AgentType::CIVILIZED &&
-          theirDef.type == AgentType::CIVILIZED) {
-        if (myDef.aggression > 0.3f)
+      if (myCivilized && t.Is(tk, SpeciesTable::CIVILIZED)) {
+        if (myAggression > 0.3f)
           isWar = true;
       }
 
       if (isWar) {
-        float damage = myStr * battleDamage * myDef.aggression;
+        float damage = myStr * battleDamage * myAggression;
         if (b.civTier) damage *= std::pow(1.5f, (float)b.civTier[i]);
         float defense = 0.0f;
         if (b.structureType) {
@@ -81,29 +87,35 @@ void Update(WorldBuffers &b, const NeighborGraph &g, const WorldSettings &s) {
         float actualDamage = std::max(0.0f, damage - defense);
         theirStr -= actualDamage;
 
-        if (actualDamage > 0 && myDef.type == AgentType::FAUNA) {
+        if (actualDamage > 0 && myFauna) {
           myStr += actualDamage * 0.5f;
         }
 
+        FactionStats::Leave(b, nIdx);
         if (theirStr <= 0.0f) {
           b.cultureID[nIdx] = myID;
           b.population[nIdx] = (uint32_t)(myStr * 0.2f);
           myStr *= 0.8f;
-          if (myDef.type == AgentType::CIVILIZED) {
+          if (myCivilized) {
+            // Names live only in the registry (cold path)
+            const std::string &name = AssetManager::agentRegistry[mk].name;
             LoreScribeNS::LogEvent(0, "CONQUEST", nIdx,
-                                   myDef.name + " conquered territory.");
+                                   name + " conquered territory.");
             // Phase 3: JSON Event for AI Perception
             nlohmann::json eventData;
-            eventData["conqueror"] = myDef.name;
+            eventData["conqueror"] = name;
             eventData["cellID"] = nIdx;
             LoreScribeNS::LogJsonEvent("CONQUEST", eventData);
           }
         } else {
           b.population[nIdx] = (uint32_t)theirStr;
         }
+        FactionStats::Enter(b, nIdx);
       }
     }
     b.population[i] = (uint32_t)myStr;
+    if (myCivilized)
+      FactionStats::Enter(b, i);
   }
 }
 } // namespace ConflictSystem
@@ -0,0 +1,161 @@
+#include "../../include/AssetManager.hpp"
+#include "../../include/Simulation.hpp"
+#include "../../include/ThreadPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace FactionStats {
+static const int CELL_GRAIN = 65536;
+static const double WEALTH_TOLERANCE = 1e-3; // Relative float drift allowed
+
+static std::vector<Totals> totals; // By species index
+static const Totals none;
+// Totals match the layers only for the table revision and map they were built
+// from; anything else waits for Ensure
+static bool valid = false;
+static int builtRevision = -1;
+static uint32_t builtCount = 0;
+
+static bool Live(const WorldBuffers &b) {
+  return valid && builtRevision == AssetManager::speciesTable.revision &&
+         builtCount == b.count;
+}
+
+// Species index of a civilized culture, NONE otherwise
+static int CivIndex(const SpeciesTable &t, int culture) {
+  int k = t.Index(culture);
+  return (k != SpeciesTable::NONE && t.Is(k, SpeciesTable::CIVILIZED))
+             ? k
+             : SpeciesTable::NONE;
+}
+
+static void AddCell(const WorldBuffers &b, int cell, int sign, Totals &f) {
+  f.population += sign * (int64_t)b.population[cell];
+  f.cells += sign;
+  if (b.structureType)
+    f.structures += sign * (int)b.structureType[cell];
+  if (b.wealth)
+    f.wealth += sign * (double)b.wealth[cell];
+}
+
+// --- DELTAS ---
+// The raw table: Species() might recompile, and a new revision already
+// invalidates the totals
+void Leave(const WorldBuffers &b, int cell) {
+  if (!Live(b))
+    return;
+  int k = CivIndex(AssetManager::speciesTable, b.cultureID[cell]);
+  if (k != SpeciesTable::NONE)
+    AddCell(b, cell, -1, totals[k]);
+}
+
+void Enter(const WorldBuffers &b, int cell) {
+  if (!Live(b))
+    return;
+  int k = CivIndex(AssetManager::speciesTable, b.cultureID[cell]);
+  if (k != SpeciesTable::NONE)
+    AddCell(b, cell, 1, totals[k]);
+}
+
+void AddWealth(const WorldBuffers &b, int cell, float delta) {
+  if (delta == 0.0f || !Live(b))
+    return;
+  int k = CivIndex(AssetManager::speciesTable, b.cultureID[cell]);
+  if (k != SpeciesTable::NONE)
+    totals[k].wealth += delta;
+}
+
+const Totals &Of(int speciesIndex) {
+  if (!valid || speciesIndex < 0 || speciesIndex >= (int)totals.size())
+    return none;
+  return totals[speciesIndex];
+}
+
+// --- FULL COUNT ---
+// Per-chunk partial totals, merged in chunk order so the wealth sum rounds
+// the same on any thread count
+static void Count(const WorldBuffers &b, const SpeciesTable &t,
+                  std::vector<Totals> &out) {
+  int n = t.Count();
+  out.assign(n, Totals());
+  if (!b.cultureID || !b.population)
+    return;
+  int chunks = ((int)b.count + CELL_GRAIN - 1) / CELL_GRAIN;
+  std::vector<std::vector<Totals>> partial(chunks, std::vector<Totals>(n));
+  ThreadPool::ParallelFor(0, chunks, 1, [&](int lo, int hi) {
+    for (int c = lo; c < hi; ++c) {
+      int end = std::min((int)b.count, (c + 1) * CELL_GRAIN);
+      for (int i = c * CELL_GRAIN; i < end; ++i) {
+        int k = CivIndex(t, b.cultureID[i]);
+        if (k != SpeciesTable::NONE)
+          AddCell(b, i, 1, partial[c][k]);
+      }
+    }
+  });
+  for (const auto &chunk : partial)
+    for (int k = 0; k < n; ++k) {
+      out[k].population += chunk[k].population;
+      out[k].cells += chunk[k].cells;
+      out[k].structures += chunk[k].structures;
+      out[k].wealth += chunk[k].wealth;
+    }
+}
+
+void Rebuild(const WorldBuffers &b) {
+  const SpeciesTable &t = AssetManager::Species();
+  Count(b, t, totals);
+  valid = true;
+  builtRevision = t.revision;
+  builtCount = b.count;
+}
+
+void Invalidate() { valid = false; }
+
+void Ensure(const WorldBuffers &b) {
+  AssetManager::Species(); // Compile first, so the revision is current
+  if (!Live(b))
+    Rebuild(b);
+}
+
+bool Validate(const WorldBuffers &b) {
+  if (!Live(b)) {
+    Rebuild(b);
+    return true;
+  }
+  const SpeciesTable &t = AssetManager::speciesTable;
+  std::vector<Totals> fresh;
+  Count(b, t, fresh);
+  bool ok = true;
+  for (int k = 0; k < t.Count(); ++k) {
+    const Totals &run = totals[k], &ref = fresh[k];
+    bool wealthOk = std::abs(run.wealth - ref.wealth) <=
+                    WEALTH_TOLERANCE * (std::abs(ref.wealth) + 1.0);
+    if (run.population == ref.population && run.cells == ref.cells &&
+        run.structures == ref.structures && wealthOk)
+      continue;
+    ok = false;
+    std::cout << "[STATS] " << AssetManager::agentRegistry[k].name
+              << " drifted: population " << run.population << " vs "
+              << ref.population << ", cells " << run.cells << " vs "
+              << ref.cells << ", structures " << run.structures << " vs "
+              << ref.structures << ", wealth " << run.wealth << " vs "
+              << ref.wealth << "\n";
+  }
+  totals.swap(fresh);
+  return ok;
+}
+
+void Publish() {
+  if (!valid)
+    return;
+  const SpeciesTable &t = AssetManager::speciesTable;
+  for (FactionData &f : AssetManager::factionRegistry) {
+    const Totals &s = Of(CivIndex(t, f.coreCultureID));
+    f.totalPopulation = (long)s.population;
+    f.totalCells = s.cells;
+  }
+}
+
+} // namespace FactionStats
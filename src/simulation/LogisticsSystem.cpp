@@ -42,6 +42,7 @@ void Update(WorldBuffers &b, const NeighborGraph &g) {
     }
 
     // 2. WEALTH CALCULATION (Legacy Buffer Liquidity)
+    float wealthBefore = b.wealth[i];
     float currentAssetWealth = AssetManager::GetTotalCellWealth(i, b);
     float production = currentAssetWealth * 0.1f; // 10% liquidity rate
     b.wealth[i] += production;
@@ -50,6 +51,7 @@ void Update(WorldBuffers &b, const NeighborGraph &g) {
     // Population eats wealth
     float consumption = pop * 0.01f;
     b.wealth[i] = std::max(0.0f, b.wealth[i] - consumption);
+    FactionStats::AddWealth(b, i, b.wealth[i] - wealthBefore);
 
     // 3. INFRASTRUCTURE SYNC
     // Infrastructure now locked to physical structures
@@ -101,7 +103,9 @@ void Update(WorldBuffers &b, const NeighborGraph &g) {
 
   // Copy back
   for (uint32_t i = 0; i < b.count; ++i) {
-    b.wealth[i] = std::max(0.0f, nextWealth[i]);
+    float w = std::max(0.0f, nextWealth[i]);
+    FactionStats::AddWealth(b, i, w - b.wealth[i]);
+    b.wealth[i] = w;
   }
 }
 
@@ -113,7 +117,9 @@ void ProcessLogistics(WorldBuffers &b, uint32_t count) {
   // Simple fallback without graph
   for (uint32_t i = 1; i < b.count - 1; ++i) {
     if (b.infrastructure[i] > 0.5f) {
+      FactionStats::Leave(b, i);
       b.population[i] += 10;
+      FactionStats::Enter(b, i);
     }
   }
 }
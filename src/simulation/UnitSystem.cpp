@@ -88,11 +88,15 @@ void ResolveCombat(WorldBuffers &b, int mapWidth) {
 
       if (u.combatStrength > defenseScore * 0.8f) {
         // Victory - capture cell
+        FactionStats::Leave(b, cellIdx);
         b.factionID[cellIdx] = u.factionID;
         b.population[cellIdx] = (uint32_t)(b.population[cellIdx] * 0.5f);
+        FactionStats::Enter(b, cellIdx);
 
-        if (b.chaos)
+        if (b.chaos) {
           b.chaos[cellIdx] += 0.1f;
+          ChaosField::MarkActive(cellIdx);
+        }
 
         LoreScribeNS::LogEvent(0, "ARMY_VICTORY", cellIdx,
                                "Military conquest by faction " +